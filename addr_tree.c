@@ -0,0 +1,161 @@
+#include "addr_tree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int max2(int a, int b) { return a > b ? a : b; }
+static size_t max_size3(size_t a, size_t b, size_t c) {
+    size_t m = a > b ? a : b;
+    return m > c ? m : c;
+}
+
+static int addr_height(struct AddrNode* node) {
+    return node ? node->height : 0;
+}
+
+static size_t addr_max(struct AddrNode* node) {
+    return node ? node->max_size : 0;
+}
+
+static void addr_fix(struct AddrNode* node) {
+    node->height = max2(addr_height(node->left), addr_height(node->right)) + 1;
+    node->max_size = max_size3(node->size, addr_max(node->left), addr_max(node->right));
+}
+
+static int addr_bfactor(struct AddrNode* node) {
+    return addr_height(node->right) - addr_height(node->left);
+}
+
+static struct AddrNode* addr_rotate_right(struct AddrNode* p) {
+    struct AddrNode* q = p->left;
+    p->left = q->right;
+    q->right = p;
+    addr_fix(p);
+    addr_fix(q);
+    return q;
+}
+
+static struct AddrNode* addr_rotate_left(struct AddrNode* q) {
+    struct AddrNode* p = q->right;
+    q->right = p->left;
+    p->left = q;
+    addr_fix(q);
+    addr_fix(p);
+    return p;
+}
+
+static struct AddrNode* addr_balance(struct AddrNode* node) {
+    addr_fix(node);
+    if (addr_bfactor(node) == 2) {
+        if (addr_bfactor(node->right) < 0)
+            node->right = addr_rotate_right(node->right);
+        return addr_rotate_left(node);
+    }
+    if (addr_bfactor(node) == -2) {
+        if (addr_bfactor(node->left) > 0)
+            node->left = addr_rotate_left(node->left);
+        return addr_rotate_right(node);
+    }
+    return node;
+}
+
+struct AddrNode* addr_insert(struct AddrNode* root, void* data, size_t size) {
+    if (!root) {
+        struct AddrNode* n = (struct AddrNode*)malloc(sizeof(struct AddrNode));
+        if (!n) return NULL;
+        n->data = data;
+        n->size = size;
+        n->max_size = size;
+        n->height = 1;
+        n->left = NULL;
+        n->right = NULL;
+        return n;
+    }
+    if ((uintptr_t)data < (uintptr_t)root->data)
+        root->left = addr_insert(root->left, data, size);
+    else
+        root->right = addr_insert(root->right, data, size);
+    return addr_balance(root);
+}
+
+static struct AddrNode* addr_find_min(struct AddrNode* root) {
+    return root->left ? addr_find_min(root->left) : root;
+}
+
+static struct AddrNode* addr_remove_min(struct AddrNode* root) {
+    if (!root->left) return root->right;
+    root->left = addr_remove_min(root->left);
+    return addr_balance(root);
+}
+
+struct AddrNode* addr_remove(struct AddrNode* root, void* data) {
+    if (!root) return NULL;
+    if ((uintptr_t)data < (uintptr_t)root->data) {
+        root->left = addr_remove(root->left, data);
+    } else if ((uintptr_t)data > (uintptr_t)root->data) {
+        root->right = addr_remove(root->right, data);
+    } else {
+        struct AddrNode* l = root->left;
+        struct AddrNode* r = root->right;
+        free(root);
+        if (!r) return l;
+        struct AddrNode* min = addr_find_min(r);
+        min->right = addr_remove_min(r);
+        min->left = l;
+        return addr_balance(min);
+    }
+    return addr_balance(root);
+}
+
+struct AddrNode* addr_find_first(struct AddrNode* root, uintptr_t from, size_t size) {
+    if (!root || root->max_size < size) return NULL;
+
+    // Ліве піддерево має менші адреси - шукаємо спершу там, якщо воно не раніше from
+    if ((uintptr_t)root->data > from) {
+        struct AddrNode* found = addr_find_first(root->left, from, size);
+        if (found) return found;
+    }
+    if ((uintptr_t)root->data >= from && root->size >= size) return root;
+    return addr_find_first(root->right, from, size);
+}
+
+void addr_foreach(struct AddrNode* node, void (*fn)(struct AddrNode*, void*), void* ctx) {
+    if (!node) return;
+    addr_foreach(node->left, fn, ctx);
+    fn(node, ctx);
+    addr_foreach(node->right, fn, ctx);
+}
+
+void addr_destroy(struct AddrNode* node) {
+    if (!node) return;
+    addr_destroy(node->left);
+    addr_destroy(node->right);
+    free(node);
+}
+
+static int check_range(struct AddrNode* node, struct AddrNode* lo, struct AddrNode* hi) {
+    if (!node) return 0;
+    int errors = 0;
+    if ((lo && (uintptr_t)node->data <= (uintptr_t)lo->data) ||
+        (hi && (uintptr_t)node->data >= (uintptr_t)hi->data)) errors++;
+    int hl = addr_height(node->left);
+    int hr = addr_height(node->right);
+    if (node->height != max2(hl, hr) + 1 || hl - hr > 1 || hr - hl > 1) errors++;
+    if (node->max_size != max_size3(node->size, addr_max(node->left), addr_max(node->right))) errors++;
+    errors += check_range(node->left, lo, node);
+    errors += check_range(node->right, node, hi);
+    return errors;
+}
+
+int addr_check(struct AddrNode* node) {
+    return check_range(node, NULL, NULL);
+}
+
+void addr_show(struct AddrNode* node) {
+    if (!node) {
+        printf("  (empty tree)\n");
+        return;
+    }
+    if (node->left) addr_show(node->left);
+    printf("  Addr: %p, Size: %zu\n", node->data, node->size);
+    if (node->right) addr_show(node->right);
+}
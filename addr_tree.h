@@ -0,0 +1,42 @@
+#ifndef ADDR_TREE_H
+#define ADDR_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * AVL-дерево вільних блоків, упорядковане за адресою. Кожен вузол
+ * зберігає найбільший розмір у своєму піддереві, тож пошук першого
+ * придатного блока (first-fit / next-fit) займає O(log n).
+ */
+struct AddrNode {
+    void* data;       // Вказівник на блок (він же ключ)
+    size_t size;      // Розмір блока
+    size_t max_size;  // Найбільший розмір у піддереві
+    int height;
+    struct AddrNode* left;
+    struct AddrNode* right;
+};
+
+/* Вставка блока з розміром */
+struct AddrNode* addr_insert(struct AddrNode* root, void* data, size_t size);
+
+/* Видалення блока за адресою */
+struct AddrNode* addr_remove(struct AddrNode* root, void* data);
+
+/* Блок з найменшою адресою, не меншою за from, і розміром >= size */
+struct AddrNode* addr_find_first(struct AddrNode* root, uintptr_t from, size_t size);
+
+/* Обхід у порядку зростання адрес */
+void addr_foreach(struct AddrNode* node, void (*fn)(struct AddrNode*, void*), void* ctx);
+
+/* Звільнення всіх вузлів */
+void addr_destroy(struct AddrNode* node);
+
+/* Перевірка порядку, висот і max_size; повертає кількість порушень */
+int addr_check(struct AddrNode* node);
+
+/* Діагностика дерева */
+void addr_show(struct AddrNode* node);
+
+#endif
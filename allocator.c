@@ -5,103 +5,384 @@
 #include <assert.h>
 #include "allocator.h"
 #include "block.h"
+#include "size_class.h"
 #include "tree.h"
-
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <unistd.h>
-#include <sys/mman.h>
-#endif
+#include "btree.h"
+#include "addr_tree.h"
+#include "hardened.h"
+#include "trace.h"
+#include "latency.h"
+#include "handle.h"
+#include "shared_heap.h"
+#include "tlsf.h"
+#include "buddy.h"
+#include "conf.h"
+#include "numa.h"
+#include "spinlock.h"
+#include "page.h"
 
 // Глобальні змінні
 size_t page_size = 4096;
 size_t default_arena_size = 4 * 4096;
 
 // Структури
+struct MemHeap;
+
 typedef struct Arena {
     size_t size;
     struct Arena* next;
+    struct MemHeap* heap;  // Купа (NUMA-вузол або mem_heap_t), якій належить арена
     int is_large;
+    bool from_buddy;       // Велика арена - блок buddy, а не окреме відображення
+    unsigned color;        // Відступ першого блока від заголовка (колір кешу)
 } Arena;
 
+// Заголовок арени вирівняний так само, як і payload блоків
+#define ARENA_HEADER_SIZE ((sizeof(Arena) + MAX_ALIGN - 1) & ~(MAX_ALIGN - 1))
+
+// Кеш звільнених блоків для кожного класу розмірів: блоки лишаються
+// зайнятими з точки зору купи й зв'язані через payload (у hardened-збірці
+// вимкнено, щоб не ховати подвійні звільнення)
+#ifndef MEM_CLASS_CACHE
+#define MEM_CLASS_CACHE (!MEM_HARDENED)
+#endif
+#ifndef MEM_CLASS_CACHE_LIMIT
+#define MEM_CLASS_CACHE_LIMIT 64
+#endif
+
+// Кольори арен: перший блок кожної наступної арени зсувається ще на
+// рядок кешу, щоб заголовки блоків і перші payload вирівняних арен не
+// падали в ті самі набори кешу. Під час ініціалізації змінюється через
+// arena_colors; 1 - без зсуву
+#ifndef MEM_ARENA_COLORS
+#define MEM_ARENA_COLORS 8
+#endif
+#define MEM_CACHE_LINE 64
+
+// Індекс вільних блоків за розміром: AVL з tree.c або B+-дерево з btree.c,
+// що на великих купах робить менше промахів кешу на пошук
+#ifndef MEM_FREE_INDEX_BTREE
+#define MEM_FREE_INDEX_BTREE 0
+#endif
+
+// Великі арени до половини цього розміру вирізаються buddy-алокатором з
+// шматків такого розміру замість окремого mmap на кожну; 0 - вимкнено.
+// Під час ініціалізації змінюється через large_threshold
+#ifndef MEM_BUDDY_CHUNK
+#define MEM_BUDDY_CHUNK (8 * 1024 * 1024)
+#endif
+
+// Стан однієї купи: власні арени, індекс вільних блоків і кеш класів.
+// Без NUMA працює лише heaps[0]; з NUMA - по купі на вузол.
+// Купи з mem_heap_create живуть окремо від heaps і зв'язані в user_heaps
+typedef struct MemHeap {
+    Arena* arena_list;
+#if MEM_FREE_INDEX_BTREE
+    BTree free_tree;
+    Block* unindexed;           // Вільні блоки, яким не вистачило вузла дерева (зв'язок у payload)
+#else
+    struct Node* free_tree;
+#endif
+    struct AddrNode* free_by_addr;
+    uintptr_t next_fit_rover;
+#if MEM_CLASS_CACHE
+    Block* class_cache[SIZE_CLASS_COUNT];
+    unsigned class_cache_count[SIZE_CLASS_COUNT];
+#endif
+    Buddy buddy;                // Шматки для середніх великих арен (одиниця - arena_align)
+    unsigned next_color;        // Колір наступної арени, від 0 до arena_colors - 1
+    spinlock_t lock;
+    MemNodeStats stats;
+    // Відображені в ОС байти (арени і шматки buddy) і межі купи (0 - немає)
+    size_t charged;
+    size_t soft_limit;
+    size_t hard_limit;
+    bool over_soft;             // Уже перетнула м'яку межу; скидається нижче неї
+    bool reserving;             // Іде mem_reserve: щойно зарезервовані арени не очищаються
+    uint64_t last_purge;        // trace_clock останнього очищення (для purge_decay_ms)
+    bool owned;                 // Створена mem_heap_create
+    struct MemHeap* next_heap;  // Наступна в user_heaps
+} Heap;
+
 // Статичні змінні
-static Arena* arena_list = NULL;
-static struct Node* free_tree = NULL;
+static Heap heaps[MEM_MAX_NUMA_NODES];
+static int heap_count = 1;
+static bool numa_enabled = false;
+// Вузлів задано більше, ніж є в системі: купи розподіляються за процесорами
+static bool numa_emulated = false;
+
+// Купи з mem_heap_create (для mem_check, перевірок hardened-режиму і mem_init)
+static Heap* user_heaps = NULL;
+static spinlock_t user_heaps_lock;
+
+// Пули підказок часу життя (mem_alloc_hint) - купи зі списку user_heaps,
+// тож mem_free, mem_check і mem_init працюють з ними як зі створеними
+static Heap* lifetime_heaps[MEM_HINT_COUNT];
+
+// Бюджет усіх куп разом: відображені байти, межі і колбек тиску
+static spinlock_t limits_lock;
+static size_t charged_total = 0;
+static size_t soft_limit_total = 0;
+static size_t hard_limit_total = 0;
+static bool total_over_soft = false;
+static MemPressureFn pressure_fn = NULL;
+static void* pressure_ctx = NULL;
+
+// Перетин м'якої межі під замком купи лише запам'ятовується; колбек
+// викликається після зняття замка, бо може сам звільняти пам'ять
+#define PRESSURE_GLOBAL 1
+#define PRESSURE_HEAP 2
+static LATENCY_THREAD_LOCAL unsigned char pressure_pending = 0;
+static LATENCY_THREAD_LOCAL Heap* pressure_heap = NULL;
+static LATENCY_THREAD_LOCAL size_t pressure_bytes[2];
+
+// Усі арени вирівняні на arena_align (степінь двійки, не менший за арену),
+// тож арену блока можна знайти маскуванням адреси
+static size_t arena_align = 4 * 4096;
+static size_t os_page_size = 4096;
+
+// Політика розміщення; first-fit і next-fit працюють з індексом за адресою
+// Уся пам'ять береться зі спільного відображення (див. shared_heap.h)
+static bool shared_mode = false;
+// Усі виділення йдуть через рушій TLSF (див. tlsf.h)
+static bool tlsf_mode = false;
+
+// Таблиця дескрипторів і їх блокування; mem_compact тримає замок весь прохід
+static spinlock_t handle_lock;
+
+// Налаштування з MemConfig, які читаються на гарячих шляхах
+static unsigned class_cache_limit = MEM_CLASS_CACHE_LIMIT;
+// Більші блоки не округлюються до класу; завжди розмір одного з класів
+static size_t size_class_limit = SIZE_CLASS_MAX;
+// Найбільший розмір для швидкого шляху mem_free_sized (size_class_limit без заголовка)
+static size_t sized_free_limit = SIZE_CLASS_MAX - BLOCK_HEADER_SIZE;
+static uint64_t purge_decay_ns = 0;
+static unsigned arena_colors = MEM_ARENA_COLORS;
+static size_t buddy_chunk = MEM_BUDDY_CHUNK;
+// Конфігурація останньої ініціалізації зі значеннями за замовчуванням (mem_config_show);
+// шлях траси - власна копія, бо рядок конфігурації може змінитися після ініціалізації
+static MemConfig effective_config;
+static char* effective_trace_path = NULL;
+
+static MemPolicy policy = MEM_POLICY_BEST_FIT;
+static unsigned good_fit_percent = MEM_GOOD_FIT_DEFAULT_PERCENT;
+
+static bool policy_by_address(void) {
+    return policy == MEM_POLICY_FIRST_FIT || policy == MEM_POLICY_NEXT_FIT;
+}
 
 // Макрос для вирівнювання
 #define ALIGN(size) align_up(size, sizeof(long double))
 
-// Системні функції
-#ifdef _WIN32
-static void* sys_alloc(size_t size) {
-    return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+// Запас під канарку після payload (лише в hardened-збірці)
+#if MEM_HARDENED
+#define CANARY_RESERVE MEM_CANARY_SIZE
+#else
+#define CANARY_RESERVE 0
+#endif
+
+// Усі звернення до ОС - через постачальника сторінок (page.h)
+static const PageProvider* pages = &page_mmap;
+
+static void* sys_alloc_aligned(size_t size, size_t align) {
+    return page_map(pages, size, align);
 }
 
 static void sys_free(void* ptr, size_t size) {
-    (void)size;
-    VirtualFree(ptr, 0, MEM_RELEASE);
+    page_unmap(pages, ptr, size);
 }
 
-static size_t get_page_size() {
-    SYSTEM_INFO sysInfo;
-    GetSystemInfo(&sysInfo);
-    return sysInfo.dwPageSize;
+// Допоміжні функції
+static Block* get_first_block(Arena* arena) {
+    return (Block*)((char*)arena + ARENA_HEADER_SIZE + arena->color);
 }
-#else
-static void* sys_alloc(size_t size) {
-    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
-                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    return (ptr == MAP_FAILED) ? NULL : ptr;
+
+// Байти арени від першого блока до кінця
+static size_t arena_data_size(Arena* arena) {
+    return arena->size - ARENA_HEADER_SIZE - arena->color;
 }
 
-static void sys_free(void* ptr, size_t size) {
-    munmap(ptr, size);
+// Арена будь-якого блока - за вирівнюванням адреси, без пошуку
+static Arena* arena_of(Block* block) {
+    return (Arena*)((uintptr_t)block & ~(uintptr_t)(arena_align - 1));
 }
 
-static size_t get_page_size() {
-    return sysconf(_SC_PAGESIZE);
+#if MEM_HARDENED
+// Повільна перевірка належності для hardened-режиму
+static Arena* find_arena_for_block(Block* block) {
+    for (int i = 0; i < heap_count; i++) {
+        for (Arena* arena = heaps[i].arena_list; arena != NULL; arena = arena->next) {
+            char* arena_start = (char*)arena;
+            char* arena_end = arena_start + arena->size;
+            if ((char*)block >= arena_start && (char*)block < arena_end) {
+                return arena;
+            }
+        }
+    }
+    for (Heap* h = user_heaps; h != NULL; h = h->next_heap) {
+        for (Arena* arena = h->arena_list; arena != NULL; arena = arena->next) {
+            if ((char*)block >= (char*)arena && (char*)block < (char*)arena + arena->size) return arena;
+        }
+    }
+    return NULL;
 }
 #endif
 
-// Допоміжні функції
-static Block* get_first_block(Arena* arena) {
-    return (Block*)((char*)arena + sizeof(Arena));
+// Вузол поточного потоку
+static int thread_node(void) {
+    if (!numa_enabled) return 0;
+    return (numa_emulated ? numa_current_cpu() : numa_current_node()) % heap_count;
 }
 
-static Arena* find_arena_for_block(Block* block) {
-    Arena* arena = arena_list;
-    while (arena != NULL) {
-        char* arena_start = (char*)arena;
-        char* arena_end = arena_start + arena->size;
-        if ((char*)block >= arena_start && (char*)block < arena_end) {
-            return arena;
+// Купа поточного потоку
+static Heap* current_heap(void) {
+    return &heaps[thread_node()];
+}
+
+static int heap_node(Heap* h) {
+    return (int)(h - heaps);
+}
+
+// Замок потрібен з NUMA, коли купи спільні для потоків вузла, і для
+// створених куп, якими можуть ділитися потоки користувача.
+// Карантин hardened-режиму глобальний, тож там усі купи ділять один замок
+#if MEM_HARDENED
+#define HEAP_LOCK(h) ((void)(h), &heaps[0].lock)
+#else
+#define HEAP_LOCK(h) (&(h)->lock)
+#endif
+
+static void heap_lock(Heap* h) {
+    if (numa_enabled || h->owned) spin_lock(HEAP_LOCK(h));
+}
+
+static void heap_unlock(Heap* h) {
+    if (numa_enabled || h->owned) spin_unlock(HEAP_LOCK(h));
+}
+
+#if MEM_FREE_INDEX_BTREE
+// Посилання на наступний блок списку unindexed
+static Block** unindexed_link(Block* block) {
+    return (Block**)block_payload(block);
+}
+
+static void unlist_unindexed(Heap* h, Block* block) {
+    for (Block** link = &h->unindexed; *link != NULL; link = unindexed_link(*link)) {
+        if (*link == block) {
+            *link = *unindexed_link(block);
+            return;
         }
-        arena = arena->next;
     }
-    return NULL;
 }
+#endif
 
-static void add_to_free_tree(size_t size, Block* block) {
+static void add_to_free_tree(Heap* h, size_t size, Block* block) {
     if (block == NULL || size == 0) return;
-    free_tree = node_insert(free_tree, size, block);
+    if (policy_by_address()) {
+        h->free_by_addr = addr_insert(h->free_by_addr, block, size);
+    } else {
+#if MEM_FREE_INDEX_BTREE
+        // Без вузла блок не губиться: чекає в списку, поки вставка не вдасться
+        if (!btree_insert(&h->free_tree, size, block)) {
+            *unindexed_link(block) = h->unindexed;
+            h->unindexed = block;
+        }
+#else
+        h->free_tree = node_insert(h->free_tree, size, block);
+#endif
+    }
+}
+
+static void remove_from_free_tree(Heap* h, size_t size, Block* block) {
+    if (policy_by_address()) {
+        h->free_by_addr = addr_remove(h->free_by_addr, block);
+    } else {
+#if MEM_FREE_INDEX_BTREE
+        if (!btree_remove(&h->free_tree, size, block)) unlist_unindexed(h, block);
+#else
+        h->free_tree = node_remove_exact(h->free_tree, size, block);
+#endif
+    }
+}
+
+static bool size_index_empty(Heap* h) {
+#if MEM_FREE_INDEX_BTREE
+    return h->free_tree.root == NULL && h->unindexed == NULL;
+#else
+    return h->free_tree == NULL;
+#endif
+}
+
+// Сусідній блок праворуч у тій самій арені
+static Block* next_block(Block* block) {
+    if (block_get_flag_last(block)) return NULL;
+    return (Block*)((char*)block + block_get_size(block));
 }
 
-static void remove_from_free_tree(size_t size) {
-    free_tree = node_remove(free_tree, size);
+// Вільний сусід, якого можна поглинути (не в карантині hardened-режиму)
+static bool can_merge(Block* block) {
+    if (block == NULL || block_get_flag_busy(block)) return false;
+#if MEM_HARDENED
+    if (hardened_in_quarantine(block)) return false;
+#endif
+    return true;
 }
 
-static Block* find_free_block(size_t size) {
-    if (free_tree == NULL) return NULL;
+// Об'єднання вільного блока з вільними сусідами; повертає підсумковий блок
+static Block* coalesce(Heap* h, Block* block) {
+    Block* next = next_block(block);
+    if (can_merge(next)) {
+        remove_from_free_tree(h, block_get_size(next), next);
+        block_set_flag_last(block, block_get_flag_last(next));
+        block_set_size(block, block_get_size(block) + block_get_size(next));
+    }
+
+    Block* prev = block_get_flag_first(block) ? NULL : block_prev(NULL, block);
+    if (can_merge(prev)) {
+        remove_from_free_tree(h, block_get_size(prev), prev);
+        block_set_flag_last(prev, block_get_flag_last(block));
+        block_set_size(prev, block_get_size(prev) + block_get_size(block));
+        block = prev;
+    }
+
+    next = next_block(block);
+    if (next != NULL) block_set_size_prev(next, block_get_size(block));
+    return block;
+}
 
-    struct Node* current = free_tree;
+#if MEM_FREE_INDEX_BTREE
+// Нижня межа вже дає найменший придатний блок з найнижчою адресою;
+// good-fit тут збігається з best-fit, бо коротшого спуску немає
+static Block* find_by_size(Heap* h, size_t size) {
+    // Блоки зі списку повертаються в дерево, щойно вузли знову виділяються
+    while (h->unindexed != NULL) {
+        Block* block = h->unindexed;
+        if (!btree_insert(&h->free_tree, block_get_size(block), block)) break;
+        h->unindexed = *unindexed_link(block);
+    }
+    Block* found = (Block*)btree_lower_bound(&h->free_tree, size, NULL);
+    for (Block* block = h->unindexed; found == NULL && block != NULL; block = *unindexed_link(block)) {
+        if (block_get_size(block) >= size) found = block;
+    }
+    return found;
+}
+#else
+static Block* find_by_size(Heap* h, size_t size) {
+    struct Node* current = h->free_tree;
     struct Node* best = NULL;
+    size_t good_enough = 0;
+
+    if (policy == MEM_POLICY_GOOD_FIT) {
+        good_enough = size + size * good_fit_percent / 100;
+    }
 
     while (current != NULL) {
         if (current->key >= size) {
-            if (best == NULL || current->key < best->key) {
-                best = current;
-            }
+            // Good-fit зупиняє спуск на першому достатньо близькому блоці
+            if (current->key <= good_enough) return (Block*)current->data;
+            // Кожен наступний кандидат менший за пару (розмір, адреса),
+            // тож серед однакових розмірів обирається найнижча адреса
+            best = current;
             current = current->left;
         } else {
             current = current->right;
@@ -110,190 +391,1642 @@ static Block* find_free_block(size_t size) {
 
     return (best != NULL) ? (Block*)best->data : NULL;
 }
+#endif
 
-// Основні функції алокатора
-void* mem_alloc(size_t size) {
-    if (size == 0) return NULL;
+static Block* find_by_address(Heap* h, size_t size) {
+    struct AddrNode* found = NULL;
 
-    size_t total_size = ALIGN(size + block_header_size());
-    if (total_size < block_header_size() * 2) {
-        total_size = block_header_size() * 2;
+    if (policy == MEM_POLICY_NEXT_FIT) {
+        // Продовжуємо з місця попереднього виділення, далі - з початку
+        found = addr_find_first(h->free_by_addr, h->next_fit_rover, size);
     }
+    if (found == NULL) {
+        found = addr_find_first(h->free_by_addr, 0, size);
+    }
+    return (found != NULL) ? (Block*)found->data : NULL;
+}
 
-    Block* block = find_free_block(total_size);
+static Block* find_free_block(Heap* h, size_t size) {
+    if (policy_by_address()) {
+        if (h->free_by_addr == NULL) return NULL;
+        return find_by_address(h, size);
+    }
+    if (size_index_empty(h)) return NULL;
+    return find_by_size(h, size);
+}
 
-    if (block != NULL) {
-        remove_from_free_tree(block_get_size(block));
+// Відрізати від вільного блока хвіст, що не потрібен запиту
+static void split_block(Heap* h, Block* block, size_t total_size) {
+    size_t block_size = block_get_size(block);
+    if (block_size < total_size + block_header_size() + 16) return;
 
-        size_t block_size = block_get_size(block);
+    size_t remaining_size = block_size - total_size;
+    Block* new_block = (Block*)((char*)block + total_size);
+    block_initialize(new_block, remaining_size, false, false, block_get_flag_last(block));
+    block_set_size_prev(new_block, total_size);
+    if (!block_get_flag_last(new_block)) {
+        block_set_size_prev(next_block(new_block), remaining_size);
+    }
 
-        if (block_size >= total_size + block_header_size() + 16) {
-            size_t remaining_size = block_size - total_size;
+    block_set_size(block, total_size);
+    block_set_flag_last(block, false);
 
-            Block* new_block = (Block*)((char*)block + total_size);
-            block_initialize(new_block, remaining_size, false, false, block_get_flag_last(block));
-            block_set_size_prev(new_block, total_size);
+    add_to_free_tree(h, remaining_size, new_block);
+}
 
-            block_set_size(block, total_size);
-            block_set_flag_last(block, false);
+// Облік size байт, які купа h збирається відобразити; false - перевищено
+// жорстку межу купи або загальну, і до ОС звертатися не слід
+static bool charge(Heap* h, size_t size) {
+    if (h->hard_limit != 0 && h->charged + size > h->hard_limit) return false;
 
-            add_to_free_tree(remaining_size, new_block);
+    spin_lock(&limits_lock);
+    bool ok = hard_limit_total == 0 || charged_total + size <= hard_limit_total;
+    if (ok) {
+        charged_total += size;
+        if (soft_limit_total != 0 && charged_total > soft_limit_total && !total_over_soft) {
+            total_over_soft = true;
+            pressure_pending |= PRESSURE_GLOBAL;
+            pressure_bytes[0] = charged_total;
         }
+    }
+    spin_unlock(&limits_lock);
+    if (!ok) return false;
 
-        block_set_flag_busy(block, true);
-        return block_payload(block);
+    h->charged += size;
+    if (h->soft_limit != 0 && h->charged > h->soft_limit && !h->over_soft) {
+        h->over_soft = true;
+        pressure_pending |= PRESSURE_HEAP;
+        pressure_heap = h;
+        pressure_bytes[1] = h->charged;
+    }
+    return true;
+}
 
-    } else {
-        size_t arena_size = (total_size > default_arena_size) ?
-                           ALIGN(total_size + sizeof(Arena)) : default_arena_size;
+static void uncharge(Heap* h, size_t size) {
+    h->charged -= size;
+    if (h->over_soft && h->charged <= h->soft_limit) h->over_soft = false;
 
-        Arena* arena = (Arena*)sys_alloc(arena_size);
-        if (arena == NULL) return NULL;
+    spin_lock(&limits_lock);
+    charged_total -= size;
+    if (total_over_soft && charged_total <= soft_limit_total) total_over_soft = false;
+    spin_unlock(&limits_lock);
+}
 
-        arena->size = arena_size;
-        arena->next = arena_list;
-        arena->is_large = (total_size > default_arena_size);
-        arena_list = arena;
+static void release_arena(Heap* h, Arena* arena);
+static void flush_class_cache(Heap* h);
 
-        block = get_first_block(arena);
-        size_t block_size = arena_size - sizeof(Arena);
-        block_initialize(block, block_size, true, true, true);
+// Реакція на тиск і mem_purge: порожні звичайні арени і запасний шматок
+// buddy повертаються ОС, а сторінки всередині решти вільних блоків -
+// скидаються; повертає зняті байти
+static size_t purge_heap(Heap* h) {
+    size_t charged = h->charged;
+    flush_class_cache(h);
+    Arena* arena = h->arena_list;
+    while (arena != NULL) {
+        Arena* next = arena->next;
+        if (arena->is_large) {
+            arena = next;
+            continue;
+        }
+        Block* first = get_first_block(arena);
+        size_t data_size = arena_data_size(arena);
+        for (Block* block = first; block != NULL; block = block_next(first, block, data_size)) {
+            if (block_get_flag_busy(block)) continue;
+#if MEM_HARDENED
+            // Отруєний вміст блоків у карантині ще перевірятиметься
+            if (hardened_in_quarantine(block)) continue;
+#endif
+            if (block == first && block_get_flag_last(block)) {
+                remove_from_free_tree(h, block_get_size(block), block);
+                release_arena(h, arena);
+                break;
+            }
+            uintptr_t start = align_up((uintptr_t)block_payload(block), os_page_size);
+            uintptr_t end = ((uintptr_t)block + block_get_size(block)) & ~(uintptr_t)(os_page_size - 1);
+            if (end > start) pages->decommit(pages->ctx, (void*)start, end - start);
+        }
+        arena = next;
+    }
 
-        if (!arena->is_large && block_size >= total_size + block_header_size() + 16) {
-            size_t remaining_size = block_size - total_size;
+    void* spare = buddy_trim(&h->buddy);
+    if (spare != NULL) {
+        LATENCY_SLOW();
+        sys_free(spare, h->buddy.chunk_size);
+        uncharge(h, h->buddy.chunk_size);
+        h->stats.buddy_chunks--;
+    }
+    h->stats.purges++;
+    if (purge_decay_ns != 0) h->last_purge = trace_clock();
+    return charged - h->charged;
+}
 
-            Block* new_block = (Block*)((char*)block + total_size);
-            block_initialize(new_block, remaining_size, false, false, true);
-            block_set_size_prev(new_block, total_size);
+// Очищення за давністю: не частіше одного на purge_decay_ms
+static void purge_decayed(Heap* h) {
+    uint64_t now = trace_clock();
+    if (h->last_purge == 0) {
+        h->last_purge = now;
+    } else if (now - h->last_purge >= purge_decay_ns && !h->reserving) {
+        purge_heap(h);
+    }
+}
 
-            block_set_size(block, total_size);
-            block_set_flag_last(block, false);
+// Викликати колбек тиску, якщо цей потік перетнув м'яку межу
+static void notify_pressure(void) {
+    unsigned char pending = pressure_pending;
+    pressure_pending = 0;
+    MemPressureFn fn = pressure_fn;
+    if (fn == NULL) return;
+    if (pending & PRESSURE_HEAP) fn(pressure_heap, pressure_bytes[1], pressure_ctx);
+    if (pending & PRESSURE_GLOBAL) fn(NULL, pressure_bytes[0], pressure_ctx);
+}
 
-            add_to_free_tree(remaining_size, new_block);
-        }
+// Порядок buddy-блока під велику арену arena_size або -1, якщо вона
+// завелика для шматка; buddy купи налаштовується при першому запиті
+static int buddy_order(Heap* h, size_t arena_size) {
+    if (buddy_chunk == 0) return -1;
+    if (h->buddy.unit == 0 && !buddy_init(&h->buddy, arena_align, buddy_chunk)) return -1;
+    return buddy_order_for(&h->buddy, arena_size);
+}
+
+// Блок buddy порядку order; ОС викликається, лише коли шматки заповнені
+static void* buddy_take(Heap* h, unsigned order) {
+    void* ptr = buddy_alloc(&h->buddy, order);
+    if (ptr != NULL) {
+        h->stats.mmaps_avoided++;
+        return ptr;
+    }
 
-        return block_payload(block);
+    size_t chunk_size = h->buddy.chunk_size;
+    if (!charge(h, chunk_size)) return NULL;
+    LATENCY_SLOW();
+    void* chunk = sys_alloc_aligned(chunk_size, chunk_size);
+    if (chunk == NULL || !buddy_add_chunk(&h->buddy, chunk)) {
+        if (chunk != NULL) sys_free(chunk, chunk_size);
+        uncharge(h, chunk_size);
+        return NULL;
     }
+    if (numa_enabled && !numa_emulated && !h->owned) numa_bind(chunk, chunk_size, heap_node(h));
+    h->stats.buddy_chunks++;
+    return buddy_alloc(&h->buddy, order);
 }
 
-void mem_free(void* ptr) {
-    if (ptr == NULL) return;
+// Відступ першого блока наступної арени купи h
+static size_t peek_color(Heap* h) {
+    return (size_t)h->next_color * MEM_CACHE_LINE;
+}
 
-    Block* block = (Block*)((char*)ptr - block_header_size());
-    Arena* arena = find_arena_for_block(block);
+// Колір для арени, перший блок якої займе total_size; звичайна арена, в
+// яку блок зі зсувом не вміщається, лишається без кольору і черги не зсуває
+static size_t take_color(Heap* h, size_t total_size, int is_large) {
+    size_t color = peek_color(h);
+    if (!is_large && total_size + ARENA_HEADER_SIZE + color > default_arena_size) return 0;
+    h->next_color = (h->next_color + 1) % arena_colors;
+    return color;
+}
 
-    if (arena == NULL) return;
+// Нова арена купи h; перший блок зайнятий і має розмір total_size
+static Block* new_arena(Heap* h, size_t total_size) {
+    int is_large = (total_size + ARENA_HEADER_SIZE > default_arena_size);
+    size_t color = take_color(h, total_size, is_large);
+    size_t arena_size = is_large ? ALIGN(total_size + ARENA_HEADER_SIZE + color) : default_arena_size;
 
-    if (arena->is_large) {
-        Arena* prev = NULL;
-        Arena* curr = arena_list;
-        while (curr != NULL && curr != arena) {
-            prev = curr;
-            curr = curr->next;
-        }
-
-        if (curr == arena) {
-            if (prev == NULL) {
-                arena_list = arena->next;
-            } else {
-                prev->next = arena->next;
+    // Середні великі арени беруться з buddy; окреме відображення - лише
+    // для більших за пів шматка або якщо шматок не вдалося відобразити
+    Arena* arena = NULL;
+    bool from_buddy = false;
+    int order = is_large ? buddy_order(h, arena_size) : -1;
+    if (order >= 0) {
+        arena = (Arena*)buddy_take(h, (unsigned)order);
+        if (arena != NULL) {
+            arena_size = h->buddy.unit << order;
+            from_buddy = true;
+        }
+    }
+    if (arena == NULL) {
+        if (!charge(h, arena_size)) {
+            h->stats.limit_failures++;
+            return NULL;
+        }
+        LATENCY_SLOW();
+        arena = (Arena*)sys_alloc_aligned(arena_size, arena_align);
+        if (arena == NULL) {
+            uncharge(h, arena_size);
+            return NULL;
+        }
+        if (numa_enabled && !numa_emulated && !h->owned) numa_bind(arena, arena_size, heap_node(h));
+    }
+    // Нова арена ще не в списку, тож очищення її не зачепить
+    if (pressure_pending && !h->reserving) purge_heap(h);
+
+    arena->size = arena_size;
+    arena->next = h->arena_list;
+    arena->heap = h;
+    arena->is_large = is_large;
+    arena->from_buddy = from_buddy;
+    arena->color = (unsigned)color;
+    h->arena_list = arena;
+    h->stats.arena_count++;
+    h->stats.mapped_bytes += arena_size;
+
+    Block* block = get_first_block(arena);
+    block_initialize(block, arena_data_size(arena), true, true, true);
+    if (!is_large) split_block(h, block, total_size);
+    latency_path = from_buddy ? MEM_LAT_BUDDY : is_large ? MEM_LAT_LARGE : MEM_LAT_ARENA;
+    return block;
+}
+
+// Основні функції алокатора
+static void* heap_alloc(Heap* h, size_t size) {
+    if (size == 0) return NULL;
+
+    if (size > SIZE_MAX / 2) return NULL;
+
+    size_t total_size = ALIGN(size + block_header_size() + CANARY_RESERVE);
+    if (total_size < block_header_size() * 2) {
+        total_size = block_header_size() * 2;
+    }
+
+    heap_lock(h);
+    h->stats.alloc_count++;
+
+    // Дрібні запити округлюються до класу; звільнений блок класу береться з кешу
+    if (total_size <= size_class_limit) {
+        unsigned cls = size_class_of(total_size);
+        total_size = size_class_size[cls];
+#if MEM_CLASS_CACHE
+        Block* cached = h->class_cache[cls];
+        if (cached != NULL) {
+            h->class_cache[cls] = *(Block**)block_payload(cached);
+            h->class_cache_count[cls]--;
+            heap_unlock(h);
+            latency_path = MEM_LAT_FAST;
+            return block_payload(cached);
+        }
+#endif
+    }
+
+    Block* block = find_free_block(h, total_size);
+
+    if (block != NULL) {
+        remove_from_free_tree(h, block_get_size(block), block);
+        h->next_fit_rover = (uintptr_t)block;
+        split_block(h, block, total_size);
+        block_set_flag_busy(block, true);
+        latency_path = MEM_LAT_TREE;
+    } else {
+        block = new_arena(h, total_size);
+    }
+
+#if MEM_HARDENED
+    if (block != NULL) hardened_arm(block, size);
+#endif
+    heap_unlock(h);
+    if (pressure_pending) notify_pressure();
+    return block != NULL ? block_payload(block) : NULL;
+}
+
+// Чи може блок такого розміру жити у звичайній арені
+static bool fits_normal_arena(size_t block_size) {
+    return block_size + ARENA_HEADER_SIZE <= default_arena_size;
+}
+
+// Від'єднати арену від купи і повернути її системі
+static void release_arena(Heap* h, Arena* arena) {
+    Arena* prev = NULL;
+    Arena* curr = h->arena_list;
+    while (curr != NULL && curr != arena) {
+        prev = curr;
+        curr = curr->next;
+    }
+
+    if (curr == arena) {
+        if (prev == NULL) {
+            h->arena_list = arena->next;
+        } else {
+            prev->next = arena->next;
+        }
+        h->stats.arena_count--;
+        h->stats.mapped_bytes -= arena->size;
+        if (arena->from_buddy) {
+            // Знімається лише шматок, що спорожнів, коли про запас уже є інший
+            size_t chunk_size = h->buddy.chunk_size;
+            void* empty = buddy_free(&h->buddy, arena, (unsigned)buddy_order_for(&h->buddy, arena->size));
+            if (empty != NULL) {
+                LATENCY_SLOW();
+                sys_free(empty, chunk_size);
+                uncharge(h, chunk_size);
+                h->stats.buddy_chunks--;
             }
+        } else {
+            LATENCY_SLOW();
+            uncharge(h, arena->size);
             sys_free(arena, arena->size);
         }
-    } else {
-        size_t block_size = block_get_size(block);
-        if (block_size > 0) {
-            block_set_flag_busy(block, false);
-            add_to_free_tree(block_size, block);
+    }
+}
+
+// Повернути звільнений блок у вільні купи-власниці (з об'єднанням)
+static void release_block(Heap* h, Block* block) {
+    block_set_flag_busy(block, false);
+#if MEM_HARDENED
+    // Блок повертається у вільні лише після виходу з карантину
+    hardened_poison(block);
+    block = hardened_quarantine_push(block);
+    if (block == NULL) return;
+    h = arena_of(block)->heap;
+#endif
+    block = coalesce(h, block);
+    add_to_free_tree(h, block_get_size(block), block);
+}
+
+// Блоки з кешу класів зайняті, тож закріпили б свої арени
+static void flush_class_cache(Heap* h) {
+#if MEM_CLASS_CACHE
+    for (unsigned cls = 0; cls < SIZE_CLASS_COUNT; cls++) {
+        while (h->class_cache[cls] != NULL) {
+            Block* cached = h->class_cache[cls];
+            h->class_cache[cls] = *(Block**)block_payload(cached);
+            release_block(h, cached);
         }
+        h->class_cache_count[cls] = 0;
     }
+#else
+    (void)h;
+#endif
 }
 
-void* mem_realloc(void* ptr, size_t size) {
-    if (ptr == NULL) return mem_alloc(size);
+static void heap_free(void* ptr) {
+    if (ptr == NULL) return;
+
+    Block* block = block_from_payload(ptr);
+
+#if MEM_HARDENED
+    if (find_arena_for_block(block) == NULL) hardened_report("free of pointer not owned by allocator", ptr);
+    hardened_check_busy(block);
+#endif
+
+    // Блок завжди повертається купі, що його виділила, навіть якщо
+    // звільняє потік з іншого вузла
+    Arena* arena = arena_of(block);
+    Heap* h = arena->heap;
+    heap_lock(h);
+    h->stats.free_count++;
+    if (numa_enabled && !h->owned && heap_node(h) != thread_node()) {
+        h->stats.remote_frees++;
+    }
+
+    // Великі блоки більші за будь-яку звичайну арену
+    size_t block_size = block_get_size(block);
+    if (!fits_normal_arena(block_size)) {
+        latency_path = arena->from_buddy ? MEM_LAT_BUDDY : MEM_LAT_LARGE;
+        if (arena->is_large) release_arena(h, arena);
+        heap_unlock(h);
+        return;
+    }
+
+#if MEM_CLASS_CACHE
+    if (block_size <= size_class_limit) {
+        unsigned cls = size_class_of(block_size);
+        if (size_class_size[cls] == block_size && h->class_cache_count[cls] < class_cache_limit) {
+            *(Block**)ptr = h->class_cache[cls];
+            h->class_cache[cls] = block;
+            h->class_cache_count[cls]++;
+            heap_unlock(h);
+            latency_path = MEM_LAT_FAST;
+            return;
+        }
+    }
+#endif
+
+    release_block(h, block);
+    if (purge_decay_ns != 0) purge_decayed(h);
+    heap_unlock(h);
+    latency_path = MEM_LAT_TREE;
+}
+
+// Новий блок, якщо потрібен, береться з купи h
+static void* heap_realloc(Heap* h, void* ptr, size_t size) {
+    if (ptr == NULL) return heap_alloc(h, size);
     if (size == 0) {
-        mem_free(ptr);
+        heap_free(ptr);
         return NULL;
     }
 
-    Block* block = (Block*)((char*)ptr - block_header_size());
-    size_t old_data_size = block_get_size(block) - block_header_size();
+    Block* block = block_from_payload(ptr);
+    size_t old_data_size = block_get_size(block) - block_header_size() - CANARY_RESERVE;
+
+    // Великий блок, що зменшився до звичайного розміру, переїжджає в арену:
+    // так окреме відображення звільняється, а mem_free_sized з новим
+    // розміром не покладе блок великої арени в кеш класу
+    bool leave_mapping = !fits_normal_arena(block_get_size(block)) &&
+                         fits_normal_arena(ALIGN(size + block_header_size() + CANARY_RESERVE));
 
-    if (size <= old_data_size) {
+#if MEM_HARDENED
+    hardened_check_busy(block);
+    if (size <= old_data_size && !leave_mapping) {
+        hardened_arm(block, size);
+        latency_path = MEM_LAT_FAST;
+        return ptr;
+    }
+    old_data_size = block->requested;
+#else
+    if (size <= old_data_size && !leave_mapping) {
+        latency_path = MEM_LAT_FAST;
         return ptr;
     }
+#endif
 
-    void* new_ptr = mem_alloc(size);
+    void* new_ptr = heap_alloc(h, size);
     if (new_ptr != NULL) {
-        memcpy(new_ptr, ptr, old_data_size);
-        mem_free(ptr);
+        // Шлях перенесення визначає виділення, а не звільнення старого блока
+        unsigned char path = latency_path;
+        memcpy(new_ptr, ptr, old_data_size < size ? old_data_size : size);
+        heap_free(ptr);
+        latency_path = path;
         return new_ptr;
     }
 
     return NULL;
 }
 
-void mem_show(void) {
-    printf("=== Memory Allocator State ===\n");
-    printf("Page size: %lu, Default arena size: %lu\n",
-           (unsigned long)page_size, (unsigned long)default_arena_size);
+// Звільнення з відомим розміром: клас рахується з size, тож дрібний блок
+// потрапляє в кеш класу без читання заголовка і пошуку арени.
+// Блок може бути більшим за клас (realloc на менший розмір), але не меншим,
+// тому для блоків з mem_alloc_aligned цей шлях не годиться
+static void heap_free_sized(void* ptr, size_t size) {
+    if (ptr == NULL) return;
 
-    Arena* arena = arena_list;
-    int arena_count = 0;
-    printf("Arenas:\n");
-    while (arena != NULL) {
-        printf("  Arena %d: %p, size: %lu, %s\n",
-               arena_count++, (void*)arena, (unsigned long)arena->size,
-               arena->is_large ? "large" : "normal");
-        arena = arena->next;
+#if MEM_HARDENED
+    Block* block = block_from_payload(ptr);
+    if (find_arena_for_block(block) == NULL) hardened_report("free of pointer not owned by allocator", ptr);
+    // Годиться будь-який розмір від запитаного до місткості блока (mem_good_size)
+    if (block_check_seal(block) && block_get_flag_busy(block) &&
+        (size < block->requested || size > block_get_size(block) - block_header_size() - CANARY_RESERVE)) {
+        hardened_report("mem_free_sized size does not match the allocation", ptr);
     }
-
-    printf("Free blocks in tree:\n");
-    if (free_tree == NULL) {
-        printf("  (empty)\n");
-    } else {
-        node_show(free_tree);
+#elif MEM_CLASS_CACHE
+    // З NUMA купу все одно треба знайти через заголовок арени; блоки
+    // створених куп і пулів підказок ідуть у власну купу під її замком.
+    // Власник - одне читання заголовка арени за маскою, не заголовка блока
+    if (!numa_enabled && size > 0 && size <= sized_free_limit &&
+        arena_of(block_from_payload(ptr))->heap == &heaps[0]) {
+        size_t total_size = ALIGN(size + block_header_size());
+        if (total_size < block_header_size() * 2) {
+            total_size = block_header_size() * 2;
+        }
+        unsigned cls = size_class_of(total_size);
+        Heap* h = &heaps[0];
+        if (h->class_cache_count[cls] < class_cache_limit) {
+            h->stats.free_count++;
+            *(Block**)ptr = h->class_cache[cls];
+            h->class_cache[cls] = block_from_payload(ptr);
+            h->class_cache_count[cls]++;
+            latency_path = MEM_LAT_FAST;
+            return;
+        }
     }
+#else
+    (void)size;
+#endif
 
-    arena = arena_list;
-    int block_count = 0;
-    printf("All blocks:\n");
-    while (arena != NULL) {
-        Block* block = get_first_block(arena);
-        size_t arena_data_size = arena->size - sizeof(Arena);
+    heap_free(ptr);
+}
 
-        while (block != NULL && block_count < 50) {
-            printf("  Block %d: %p, size: %lu, busy: %d, first: %d, last: %d\n",
-                   block_count++, (void*)block,
-                   (unsigned long)block_get_size(block),
-                   block_get_flag_busy(block),
-                   block_get_flag_first(block),
-                   block_get_flag_last(block));
+// Відрізати хвіст зайнятого блока понад total_size і повернути його у вільні
+static void trim_tail(Heap* h, Block* block, size_t total_size) {
+    size_t block_size = block_get_size(block);
+    if (block_size < total_size + block_header_size() * 2) return;
 
-            Block* next = block_next(block, block, arena_data_size);
-            if (next == NULL || next == block || (char*)next >= (char*)arena + arena->size) {
-                break;
-            }
-            block = next;
-        }
-        arena = arena->next;
+    size_t tail_size = block_size - total_size;
+    Block* tail = (Block*)((char*)block + total_size);
+    block_initialize(tail, tail_size, true, false, block_get_flag_last(block));
+    block_set_size_prev(tail, total_size);
+    if (!block_get_flag_last(tail)) {
+        block_set_size_prev(next_block(tail), tail_size);
     }
-    printf("=== End of State ===\n");
+    block_set_size(block, total_size);
+    block_set_flag_last(block, false);
+
+    // Сусід справа може бути вільним (блок міг прийти з кешу класу)
+    release_block(h, tail);
 }
 
-void mem_init(size_t custom_page_size, size_t custom_arena_size) {
-    if (custom_page_size > 0) {
-        page_size = custom_page_size;
-    } else {
-        page_size = get_page_size();
+// Виділення з вирівнюванням понад MAX_ALIGN: береться блок із запасом,
+// вирівняний payload вирізається з його середини, голова і хвіст звільняються
+static void* heap_alloc_aligned(Heap* h, size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment <= MAX_ALIGN) return heap_alloc(h, size);
+    if (size == 0 || size > SIZE_MAX / 4) return NULL;
+    // arena_of шукає арену маскуванням, тож блок має лежати в межах arena_align від її початку
+    if (alignment > arena_align / 2) return NULL;
+
+    // Голова має вміщати щонайменше мінімальний блок
+    size_t min_gap = block_header_size() * 2;
+    size_t request = size + alignment + min_gap;
+
+    // Великий блок після обрізання має лишитися великим, інакше free
+    // сплутає його зі звичайним; тому запас рахується від розміру арени
+    bool large = !fits_normal_arena(ALIGN(request + block_header_size() + CANARY_RESERVE));
+    if (large) {
+        request = (size > default_arena_size ? size : default_arena_size) + alignment + min_gap;
     }
 
-    if (custom_arena_size > 0) {
-        default_arena_size = custom_arena_size;
-    } else {
-        default_arena_size = 4 * page_size;
+    void* ptr = heap_alloc(h, request);
+    if (ptr == NULL) return NULL;
+    if (((uintptr_t)ptr & (alignment - 1)) == 0) {
+#if MEM_HARDENED
+        hardened_arm(block_from_payload(ptr), size);
+#endif
+        return ptr;
+    }
+
+    Block* block = block_from_payload(ptr);
+    Arena* arena = arena_of(block);
+    h = arena->heap;
+    heap_lock(h);
+
+    uintptr_t aligned = ((uintptr_t)ptr + min_gap + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    size_t gap = (size_t)(aligned - (uintptr_t)ptr);
+    size_t block_size = block_get_size(block);
+    Block* result = (Block*)((char*)block + gap);
+
+    block_initialize(result, block_size - gap, true, false, block_get_flag_last(block));
+    block_set_size_prev(result, gap);
+    if (!block_get_flag_last(result)) {
+        block_set_size_prev(next_block(result), block_size - gap);
     }
+    block_set_size(block, gap);
+    block_set_flag_last(block, false);
+
+    if (arena->is_large) {
+        // Голова великої арени лишається зайнятою підкладкою і зникає разом з ареною
+#if MEM_HARDENED
+        hardened_arm(block, 0);
+#endif
+    } else {
+        release_block(h, block);
+        size_t total_size = ALIGN(size + block_header_size() + CANARY_RESERVE);
+        trim_tail(h, result, total_size);
+    }
+
+#if MEM_HARDENED
+    hardened_arm(result, size);
+#endif
+    heap_unlock(h);
+    return block_payload(result);
+}
+
+// Публічний API: тонкі обгортки, що також пишуть трасу
+// Дескрипторні блоки: на початку payload лежить зворотне посилання на слот
+#define HANDLE_PREFIX ALIGN(sizeof(MemHandleSlot*))
+
+// Слот дескриптора, якщо зайнятий блок належить переміщуваному об'єкту
+static MemHandleSlot* handle_of(Block* block) {
+    MemHandleSlot* slot = *(MemHandleSlot**)block_payload(block);
+    if (!handle_slot_valid(slot) || slot->block != block) return NULL;
+    return slot;
+}
+
+// Обхід арени: зайняті байти і чи всі зайняті блоки можна перемістити
+static size_t scan_arena(Arena* arena, bool* movable) {
+    Block* first = get_first_block(arena);
+    size_t data_size = arena_data_size(arena);
+    size_t busy = 0;
+    *movable = true;
+
+    for (Block* block = first; block != NULL; block = block_next(first, block, data_size)) {
+        if (!block_get_flag_busy(block)) {
+#if MEM_HARDENED
+            // Блок у карантині не в індексі, і зняти його звідти не можна
+            if (hardened_in_quarantine(block)) *movable = false;
+#endif
+            continue;
+        }
+        busy += block_get_size(block);
+        MemHandleSlot* slot = handle_of(block);
+        if (slot == NULL || slot->locks > 0) *movable = false;
+    }
+    return busy;
+}
+
+// Прибрати вільні блоки арени з індексу, щоб переміщення не цілили в неї
+static void unindex_arena(Heap* h, Arena* arena) {
+    Block* first = get_first_block(arena);
+    size_t data_size = arena_data_size(arena);
+    for (Block* block = first; block != NULL; block = block_next(first, block, data_size)) {
+        if (!block_get_flag_busy(block)) remove_from_free_tree(h, block_get_size(block), block);
+    }
+}
+
+// Злити сусідні вільні блоки арени і повернути їх в індекс
+static void reindex_arena(Heap* h, Arena* arena) {
+    Block* block = get_first_block(arena);
+    while (block != NULL) {
+        if (block_get_flag_busy(block)) {
+            block = next_block(block);
+            continue;
+        }
+        Block* next = next_block(block);
+        while (next != NULL && !block_get_flag_busy(next)) {
+            block_set_flag_last(block, block_get_flag_last(next));
+            block_set_size(block, block_get_size(block) + block_get_size(next));
+            next = next_block(block);
+        }
+        if (next != NULL) block_set_size_prev(next, block_get_size(block));
+        add_to_free_tree(h, block_get_size(block), block);
+        block = next;
+    }
+}
+
+// Перенести дескрипторний блок у вільний блок іншої арени; false - місця немає
+static bool move_block(Heap* h, Block* block) {
+    size_t size = block_get_size(block);
+    Block* target = find_free_block(h, size);
+    if (target == NULL) return false;
+
+    remove_from_free_tree(h, block_get_size(target), target);
+    split_block(h, target, size);
+    block_set_flag_busy(target, true);
+    memcpy(block_payload(target), block_payload(block), size - block_header_size());
+#if MEM_HARDENED
+    hardened_arm(target, block->requested);
+#endif
+
+    MemHandleSlot* slot = *(MemHandleSlot**)block_payload(block);
+    slot->block = target;
+    block_set_flag_busy(block, false);
+    return true;
+}
+
+typedef struct CompactCandidate {
+    Arena* arena;
+    size_t busy;
+} CompactCandidate;
+
+static int compare_candidates(const void* a, const void* b) {
+    size_t x = ((const CompactCandidate*)a)->busy;
+    size_t y = ((const CompactCandidate*)b)->busy;
+    return (x > y) - (x < y);
+}
+
+// Звільнити арени купи, заповнені менш ніж наполовину лише незаблокованими
+// дескрипторними блоками; найрозрідженіші - першими
+static size_t compact_heap(Heap* h, size_t budget) {
+    flush_class_cache(h);
+
+    size_t count = 0;
+    for (Arena* arena = h->arena_list; arena != NULL; arena = arena->next) count++;
+    CompactCandidate* candidates = (CompactCandidate*)malloc(count * sizeof(CompactCandidate) + 1);
+    if (candidates == NULL) return 0;
+
+    count = 0;
+    for (Arena* arena = h->arena_list; arena != NULL; arena = arena->next) {
+        if (arena->is_large) continue;
+        bool movable;
+        size_t busy = scan_arena(arena, &movable);
+        if (movable && busy * 2 < arena->size) {
+            candidates[count].arena = arena;
+            candidates[count].busy = busy;
+            count++;
+        }
+    }
+    qsort(candidates, count, sizeof(CompactCandidate), compare_candidates);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < count; i++) {
+        Arena* arena = candidates[i].arena;
+        // Попередні переміщення могли наповнити цю арену
+        bool movable;
+        size_t busy = scan_arena(arena, &movable);
+        if (!movable || busy * 2 >= arena->size) continue;
+        if (moved + busy > budget) break;
+
+        unindex_arena(h, arena);
+        bool complete = true;
+        Block* first = get_first_block(arena);
+        size_t data_size = arena_data_size(arena);
+        for (Block* block = first; block != NULL; block = block_next(first, block, data_size)) {
+            if (!block_get_flag_busy(block)) continue;
+            if (!move_block(h, block)) {
+                complete = false;
+                break;
+            }
+            moved += block_get_size(block);
+        }
+
+        if (complete) {
+            release_arena(h, arena);
+        } else {
+            // Решті арен місця теж не знайдеться
+            reindex_arena(h, arena);
+            break;
+        }
+    }
+
+    free(candidates);
+    return moved;
+}
+
+void* mem_alloc(size_t size) {
+    LATENCY_BEGIN();
+    void* ptr;
+    if (shared_mode) {
+        ptr = shared_alloc(size);
+    } else if (tlsf_mode) {
+        ptr = tlsf_alloc(size);
+    } else {
+        ptr = heap_alloc(current_heap(), size);
+    }
+    LATENCY_END(MEM_LAT_ALLOC);
+    if (trace_enabled) trace_record(TRACE_OP_ALLOC, ptr, NULL, size);
+    return ptr;
+}
+
+void* mem_alloc_aligned(size_t alignment, size_t size) {
+    LATENCY_BEGIN();
+    void* ptr;
+    if (shared_mode) {
+        // Спільна купа вирівнює лише до MAX_ALIGN
+        ptr = alignment != 0 && alignment <= MAX_ALIGN && (alignment & (alignment - 1)) == 0 ?
+              shared_alloc(size) : NULL;
+    } else if (tlsf_mode) {
+        ptr = tlsf_alloc_aligned(alignment, size);
+    } else {
+        ptr = heap_alloc_aligned(current_heap(), alignment, size);
+    }
+    LATENCY_END(MEM_LAT_ALLOC);
+    if (trace_enabled) trace_record(TRACE_OP_ALLOC, ptr, NULL, size);
+    return ptr;
+}
+
+size_t mem_usable_size(void* ptr) {
+    if (ptr == NULL) return 0;
+    Block* block = block_from_payload(ptr);
+#if MEM_HARDENED
+    // За requested лежить канарка, тож запас використати не можна
+    hardened_check_busy(block);
+    return block->requested;
+#else
+    // Дрібний блок буває більшим за свій клас (залишок не відрізався);
+    // округлення вниз до класу тримає mem_free_sized з цим розміром безпечним
+    size_t block_size = block_get_size(block);
+    if (block_size <= size_class_limit) {
+        unsigned cls = size_class_of(block_size);
+        if (size_class_size[cls] > block_size) cls--;
+        block_size = size_class_size[cls];
+    }
+    return block_size - block_header_size();
+#endif
+}
+
+size_t mem_good_size(size_t size) {
+    if (size == 0 || size > SIZE_MAX / 2) return size;
+
+    size_t total_size = ALIGN(size + block_header_size() + CANARY_RESERVE);
+    if (total_size < block_header_size() * 2) {
+        total_size = block_header_size() * 2;
+    }
+    if (total_size <= size_class_limit) {
+        total_size = size_class_size[size_class_of(total_size)];
+    }
+    return total_size - block_header_size() - CANARY_RESERVE;
+}
+
+void mem_free(void* ptr) {
+    if (ptr == NULL) return;
+    if (trace_enabled) trace_record(TRACE_OP_FREE, ptr, NULL, 0);
+    LATENCY_BEGIN();
+    if (shared_mode) {
+        shared_free(ptr);
+    } else if (tlsf_mode) {
+        tlsf_free(ptr);
+    } else {
+        heap_free(ptr);
+    }
+    LATENCY_END(MEM_LAT_FREE);
+}
+
+void mem_free_sized(void* ptr, size_t size) {
+    if (ptr == NULL) return;
+    if (trace_enabled) trace_record(TRACE_OP_FREE, ptr, NULL, 0);
+    LATENCY_BEGIN();
+    if (shared_mode) {
+        shared_free(ptr);
+    } else if (tlsf_mode) {
+        tlsf_free(ptr);
+    } else {
+        heap_free_sized(ptr, size);
+    }
+    LATENCY_END(MEM_LAT_FREE);
+}
+
+// Блок з пулу часу життя і переноситься в той самий пул, решта - в купу потоку;
+// поки підказками не користувалися, заголовок арени не читається
+static Heap* realloc_heap(void* ptr) {
+    if (ptr != NULL && (lifetime_heaps[MEM_HINT_SHORT] != NULL || lifetime_heaps[MEM_HINT_LONG] != NULL)) {
+#if MEM_HARDENED
+        // Чужий вказівник має дійти до перевірок heap_realloc, а не до заголовка арени
+        Arena* arena = find_arena_for_block(block_from_payload(ptr));
+        if (arena == NULL) return current_heap();
+#else
+        Arena* arena = arena_of(block_from_payload(ptr));
+#endif
+        Heap* h = arena->heap;
+        if (h == lifetime_heaps[MEM_HINT_SHORT] || h == lifetime_heaps[MEM_HINT_LONG]) return h;
+    }
+    return current_heap();
+}
+
+void* mem_realloc(void* ptr, size_t size) {
+    // Момент - до операції, як у mem_free: старий блок звільняється всередині
+    uint64_t stamp = trace_enabled ? trace_clock() : 0;
+    LATENCY_BEGIN();
+    void* new_ptr;
+    if (shared_mode) {
+        new_ptr = shared_realloc(ptr, size);
+    } else if (tlsf_mode) {
+        new_ptr = tlsf_realloc(ptr, size);
+    } else {
+        new_ptr = heap_realloc(realloc_heap(ptr), ptr, size);
+    }
+    LATENCY_END(MEM_LAT_REALLOC);
+    if (trace_enabled) trace_record_at(TRACE_OP_REALLOC, new_ptr, ptr, size, stamp);
+    return new_ptr;
+}
+
+MemHandle mem_handle_alloc(size_t size) {
+    if (size == 0 || size > SIZE_MAX / 2) return NULL;
+    void* ptr = mem_alloc(size + HANDLE_PREFIX);
+    if (ptr == NULL) return NULL;
+
+    spin_lock(&handle_lock);
+    MemHandleSlot* slot = handle_slot_alloc();
+    if (slot != NULL) {
+        *(MemHandleSlot**)ptr = slot;
+        slot->block = block_from_payload(ptr);
+    }
+    spin_unlock(&handle_lock);
+
+    if (slot == NULL) mem_free(ptr);
+    return slot;
+}
+
+void* mem_handle_lock(MemHandle handle) {
+    if (handle == NULL) return NULL;
+    spin_lock(&handle_lock);
+    handle->locks++;
+    void* ptr = (char*)block_payload((Block*)handle->block) + HANDLE_PREFIX;
+    spin_unlock(&handle_lock);
+    return ptr;
+}
+
+void mem_handle_unlock(MemHandle handle) {
+    if (handle == NULL) return;
+    spin_lock(&handle_lock);
+    if (handle->locks > 0) handle->locks--;
+    spin_unlock(&handle_lock);
+}
+
+void mem_handle_free(MemHandle handle) {
+    if (handle == NULL) return;
+    spin_lock(&handle_lock);
+    void* ptr = block_payload((Block*)handle->block);
+    handle_slot_free(handle);
+    // Посилання на слот стирається, щоб блок більше не впізнавався як дескрипторний
+    *(MemHandleSlot**)ptr = NULL;
+    spin_unlock(&handle_lock);
+    mem_free(ptr);
+}
+
+size_t mem_compact(size_t budget) {
+    size_t moved = 0;
+    // Дескриптори процесу-локальні, а спільна купа ділиться між процесами
+    if (shared_mode) return 0;
+    spin_lock(&handle_lock);
+    for (int i = 0; i < heap_count && moved < budget; i++) {
+        heap_lock(&heaps[i]);
+        moved += compact_heap(&heaps[i], budget - moved);
+        heap_unlock(&heaps[i]);
+    }
+    spin_unlock(&handle_lock);
+    return moved;
+}
+
+void* mem_shared_root(void) {
+    return shared_mode ? shared_root() : NULL;
+}
+
+void mem_shared_set_root(void* ptr) {
+    if (shared_mode) shared_set_root(ptr);
+}
+
+size_t mem_shared_offset(void* ptr) {
+    return shared_mode ? (size_t)shared_offset(ptr) : 0;
+}
+
+void* mem_shared_ptr(size_t offset) {
+    return shared_mode ? shared_ptr(offset) : NULL;
+}
+
+bool mem_trace_start(const char* path) {
+    return trace_start(path);
+}
+
+void mem_trace_stop(void) {
+    trace_stop();
+}
+
+// Перевірка цілісності купи
+typedef struct CheckState {
+    Block** free_blocks;
+    size_t free_count;
+    size_t free_cap;
+    unsigned char* seen;
+    int errors;
+} CheckState;
+
+static void check_fail(CheckState* st, const char* what, void* where) {
+    if (st->errors < 20) {
+        fprintf(stderr, "mem_check: %s (%p)\n", what, where);
+    }
+    st->errors++;
+}
+
+static void check_note_free(CheckState* st, Block* block) {
+    if (st->free_count == st->free_cap) {
+        size_t cap = st->free_cap ? st->free_cap * 2 : 64;
+        Block** grown = (Block**)realloc(st->free_blocks, cap * sizeof(Block*));
+        if (grown == NULL) return;
+        st->free_blocks = grown;
+        st->free_cap = cap;
+    }
+    st->free_blocks[st->free_count++] = block;
+}
+
+static int compare_blocks(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(Block* const*)a;
+    uintptr_t y = (uintptr_t)*(Block* const*)b;
+    return (x > y) - (x < y);
+}
+
+static void check_arena(CheckState* st, Arena* arena) {
+    if (arena->color % MEM_CACHE_LINE != 0 || ARENA_HEADER_SIZE + arena->color >= arena->size) {
+        check_fail(st, "arena color is out of range", arena);
+        return;
+    }
+    char* start = (char*)get_first_block(arena);
+    char* end = (char*)arena + arena->size;
+    Block* block = (Block*)start;
+    size_t prev_size = 0;
+    bool prev_free = false;
+
+    if (arena->is_large) {
+        if (!block_get_flag_busy(block) || !block_get_flag_first(block)) {
+            check_fail(st, "large arena block must be busy and first", block);
+            return;
+        }
+        // Перед вирівняним блоком може стояти зайнята підкладка
+        if (!block_get_flag_last(block)) {
+            size_t pad = block_get_size(block);
+            block = (Block*)((char*)block + pad);
+            if ((char*)block >= end || !block_get_flag_busy(block) ||
+                block_get_size_prev(block) != pad || !block_get_flag_last(block)) {
+                check_fail(st, "large arena has a broken alignment pad", block);
+                return;
+            }
+        }
+        if ((char*)block + block_get_size(block) != end) {
+            check_fail(st, "blocks do not tile the arena", block);
+        }
+        return;
+    }
+
+    for (;;) {
+        size_t size = block_get_size(block);
+        if (size < block_header_size() || (char*)block + size > end) {
+            check_fail(st, "block size does not fit the arena", block);
+            return;
+        }
+        if (block_get_size_prev(block) != prev_size) {
+            check_fail(st, "prev_size_flags does not match previous block", block);
+        }
+        if (block_get_flag_first(block) != ((char*)block == start)) {
+            check_fail(st, "wrong first flag", block);
+        }
+
+        bool is_free = !block_get_flag_busy(block);
+#if MEM_HARDENED
+        bool merged = is_free && !hardened_in_quarantine(block);
+#else
+        bool merged = is_free;
+#endif
+        if (merged) {
+            if (prev_free) check_fail(st, "adjacent free blocks were not coalesced", block);
+            check_note_free(st, block);
+        }
+        prev_free = merged;
+
+        char* after = (char*)block + size;
+        if (block_get_flag_last(block)) {
+            if (after != end) check_fail(st, "blocks do not tile the arena", block);
+            return;
+        }
+        if (after >= end) {
+            check_fail(st, "last block is missing the last flag", block);
+            return;
+        }
+        prev_size = size;
+        block = (Block*)after;
+    }
+}
+
+static void check_index_entry(CheckState* st, Block* block, size_t key) {
+    Block** found = st->free_count == 0 ? NULL :
+        (Block**)bsearch(&block, st->free_blocks, st->free_count, sizeof(Block*), compare_blocks);
+
+    if (found == NULL) {
+        check_fail(st, "free index entry does not point to a free block", block);
+        return;
+    }
+    if (key != block_get_size(block)) {
+        check_fail(st, "free index key differs from block size", block);
+    }
+    size_t i = (size_t)(found - st->free_blocks);
+    if (st->seen[i]++) {
+        check_fail(st, "free block appears in the index more than once", block);
+    }
+}
+
+#if MEM_FREE_INDEX_BTREE
+static void check_size_entry(size_t key, void* data, void* ctx) {
+    check_index_entry((CheckState*)ctx, (Block*)data, key);
+}
+#else
+static void check_size_entry(struct Node* node, void* ctx) {
+    check_index_entry((CheckState*)ctx, (Block*)node->data, node->key);
+}
+#endif
+
+static void check_addr_entry(struct AddrNode* node, void* ctx) {
+    check_index_entry((CheckState*)ctx, (Block*)node->data, node->size);
+}
+
+// Перевірка однієї купи: її арени, її індекс і належність арен саме їй
+static void check_heap(CheckState* st, Heap* h) {
+    st->free_count = 0;
+
+    for (Arena* arena = h->arena_list; arena != NULL; arena = arena->next) {
+        if (arena->heap != h) check_fail(st, "arena is listed in a foreign heap", arena);
+        if (((uintptr_t)arena & (arena_align - 1)) != 0) check_fail(st, "arena is not aligned", arena);
+        check_arena(st, arena);
+    }
+
+#if MEM_FREE_INDEX_BTREE
+    if (btree_check(&h->free_tree) != 0) {
+        check_fail(st, "free index is not a valid B+ tree", h->free_tree.root);
+    }
+#else
+    if (node_check(h->free_tree) != 0) {
+        check_fail(st, "free index is not a valid AVL tree", h->free_tree);
+    }
+#endif
+    if (addr_check(h->free_by_addr) != 0) {
+        check_fail(st, "free index is not a valid AVL tree", h->free_by_addr);
+    }
+    if (buddy_check(&h->buddy) != 0) {
+        check_fail(st, "buddy free lists are inconsistent", h->buddy.chunks);
+    }
+    if (policy_by_address() ? !size_index_empty(h) : h->free_by_addr != NULL) {
+        check_fail(st, "index of the inactive policy is not empty", NULL);
+    }
+
+    free(st->seen);
+    st->seen = NULL;
+    if (st->free_count > 0) {
+        qsort(st->free_blocks, st->free_count, sizeof(Block*), compare_blocks);
+        st->seen = (unsigned char*)calloc(st->free_count, 1);
+        if (st->seen == NULL) return;
+    }
+
+    // Запис індексу, що вказує на блок чужої купи, теж не знайдеться
+    if (policy_by_address()) {
+        addr_foreach(h->free_by_addr, check_addr_entry, st);
+    } else {
+#if MEM_FREE_INDEX_BTREE
+        btree_foreach(&h->free_tree, check_size_entry, st);
+        for (Block* block = h->unindexed; block != NULL; block = *unindexed_link(block)) {
+            check_index_entry(st, block, block_get_size(block));
+        }
+#else
+        node_foreach(h->free_tree, check_size_entry, st);
+#endif
+    }
+    for (size_t i = 0; i < st->free_count; i++) {
+        if (!st->seen[i]) check_fail(st, "free block is missing from the index", st->free_blocks[i]);
+    }
+}
+
+int mem_check(void) {
+    CheckState st = {NULL, 0, 0, NULL, 0};
+
+    if (shared_mode) return shared_check();
+    if (tlsf_mode) return tlsf_check();
+
+    for (int i = 0; i < heap_count; i++) {
+        check_heap(&st, &heaps[i]);
+    }
+    for (Heap* h = user_heaps; h != NULL; h = h->next_heap) {
+        check_heap(&st, h);
+    }
+
+    free(st.seen);
+    free(st.free_blocks);
+    return st.errors;
+}
+
+static void show_heap(Heap* h, int* block_count) {
+    Arena* arena = h->arena_list;
+    int arena_count = 0;
+    printf("Arenas:\n");
+    while (arena != NULL) {
+        printf("  Arena %d: %p, size: %lu, %s\n",
+               arena_count++, (void*)arena, (unsigned long)arena->size,
+               arena->from_buddy ? "buddy" : arena->is_large ? "large" : "normal");
+        arena = arena->next;
+    }
+
+    printf("Free blocks in tree:\n");
+    if (policy_by_address() && h->free_by_addr != NULL) {
+        addr_show(h->free_by_addr);
+    } else if (size_index_empty(h)) {
+        printf("  (empty)\n");
+    } else {
+#if MEM_FREE_INDEX_BTREE
+        btree_show(&h->free_tree);
+        for (Block* block = h->unindexed; block != NULL; block = *unindexed_link(block)) {
+            printf("  Key: %zu, Data: %p (no tree node)\n", block_get_size(block), (void*)block);
+        }
+#else
+        node_show(h->free_tree);
+#endif
+    }
+
+    arena = h->arena_list;
+    printf("All blocks:\n");
+    while (arena != NULL) {
+        Block* block = get_first_block(arena);
+        size_t data_size = arena_data_size(arena);
+
+        while (block != NULL && *block_count < 50) {
+            printf("  Block %d: %p, size: %lu, busy: %d, first: %d, last: %d\n",
+                   (*block_count)++, (void*)block,
+                   (unsigned long)block_get_size(block),
+                   block_get_flag_busy(block),
+                   block_get_flag_first(block),
+                   block_get_flag_last(block));
+
+            Block* next = block_next(block, block, data_size);
+            if (next == NULL || next == block || (char*)next >= (char*)arena + arena->size) {
+                break;
+            }
+            block = next;
+        }
+        arena = arena->next;
+    }
+}
+
+void mem_show(void) {
+    int block_count = 0;
+
+    printf("=== Memory Allocator State ===\n");
+    printf("Page size: %lu, Default arena size: %lu\n",
+           (unsigned long)page_size, (unsigned long)default_arena_size);
+
+    if (shared_mode) {
+        MemStats stats;
+        shared_stats(&stats);
+        printf("Shared heap: %lu arenas, %lu bytes, %lu free blocks\n",
+               (unsigned long)stats.arena_count, (unsigned long)stats.mapped_bytes,
+               (unsigned long)stats.free_blocks);
+    }
+    if (tlsf_mode) {
+        MemStats stats;
+        tlsf_stats(&stats);
+        printf("TLSF: %lu pools, %lu bytes, %lu free blocks, largest %lu\n",
+               (unsigned long)stats.arena_count, (unsigned long)stats.mapped_bytes,
+               (unsigned long)stats.free_blocks, (unsigned long)stats.largest_free);
+    }
+    for (int i = 0; i < heap_count; i++) {
+        if (numa_enabled) printf("--- NUMA node %d ---\n", i);
+        show_heap(&heaps[i], &block_count);
+    }
+    printf("=== End of State ===\n");
+}
+
+// Додати до stats арени купи h і вільні блоки звичайних арен
+static void add_heap_stats(Heap* h, MemStats* stats) {
+    stats->mmaps_avoided += h->stats.mmaps_avoided;
+    for (Arena* arena = h->arena_list; arena != NULL; arena = arena->next) {
+        stats->arena_count++;
+        stats->mapped_bytes += arena->size;
+        if (arena->is_large) continue;
+
+        Block* block = get_first_block(arena);
+        for (;;) {
+            size_t size = block_get_size(block);
+            if (!block_get_flag_busy(block)) {
+                stats->free_blocks++;
+                stats->free_bytes += size;
+                if (size > stats->largest_free) stats->largest_free = size;
+            }
+            if (block_get_flag_last(block) || size == 0) break;
+            block = (Block*)((char*)block + size);
+        }
+    }
+}
+
+void mem_stats(MemStats* stats) {
+    if (stats == NULL) return;
+    if (shared_mode) {
+        shared_stats(stats);
+        return;
+    }
+    if (tlsf_mode) {
+        tlsf_stats(stats);
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < heap_count; i++) add_heap_stats(&heaps[i], stats);
+}
+
+int mem_numa_node_count(void) {
+    return numa_enabled ? heap_count : 1;
+}
+
+void mem_node_stats(int node, MemNodeStats* stats) {
+    if (stats == NULL) return;
+    memset(stats, 0, sizeof(*stats));
+    if (node < 0 || node >= heap_count) return;
+
+    heap_lock(&heaps[node]);
+    *stats = heaps[node].stats;
+    heap_unlock(&heaps[node]);
+    stats->node = node;
+}
+
+// Повернути системі все, що має купа, і очистити її стан
+static void heap_reset(Heap* h) {
+    while (h->arena_list != NULL) {
+        Arena* next = h->arena_list->next;
+        if (!h->arena_list->from_buddy) sys_free(h->arena_list, h->arena_list->size);
+        h->arena_list = next;
+    }
+    buddy_reset(&h->buddy, sys_free);
+    uncharge(h, h->charged);
+#if MEM_FREE_INDEX_BTREE
+    btree_destroy(&h->free_tree);
+#else
+    node_destroy(h->free_tree);
+#endif
+    addr_destroy(h->free_by_addr);
+    memset(h, 0, sizeof(*h));
+}
+
+// Перевищення, наявне на момент виклику, спрацює при наступному відображенні
+void mem_set_limits(size_t soft_limit, size_t hard_limit) {
+    spin_lock(&limits_lock);
+    soft_limit_total = soft_limit;
+    hard_limit_total = hard_limit;
+    total_over_soft = false;
+    spin_unlock(&limits_lock);
+}
+
+void mem_set_pressure_callback(MemPressureFn fn, void* ctx) {
+    spin_lock(&limits_lock);
+    pressure_fn = fn;
+    pressure_ctx = ctx;
+    spin_unlock(&limits_lock);
+}
+
+size_t mem_purge(void) {
+    if (shared_mode || tlsf_mode) return 0;
+    size_t released = 0;
+    for (int i = 0; i < heap_count; i++) {
+        heap_lock(&heaps[i]);
+        released += purge_heap(&heaps[i]);
+        heap_unlock(&heaps[i]);
+    }
+    spin_lock(&user_heaps_lock);
+    for (Heap* h = user_heaps; h != NULL; h = h->next_heap) {
+        heap_lock(h);
+        released += purge_heap(h);
+        heap_unlock(h);
+    }
+    spin_unlock(&user_heaps_lock);
+    return released;
+}
+
+mem_heap_t* mem_heap_create(void) {
+    // Спільна купа і TLSF одні на процес і окремих арен не мають
+    if (shared_mode || tlsf_mode) return NULL;
+    Heap* h = (Heap*)calloc(1, sizeof(Heap));
+    if (h == NULL) return NULL;
+    h->owned = true;
+
+    spin_lock(&user_heaps_lock);
+    h->next_heap = user_heaps;
+    user_heaps = h;
+    spin_unlock(&user_heaps_lock);
+    return h;
+}
+
+// Арени знімаються цілком: блоки, кеш класів і вміст купи не обходяться
+void mem_heap_destroy(mem_heap_t* heap) {
+    if (heap == NULL) return;
+
+    spin_lock(&user_heaps_lock);
+    Heap** link = &user_heaps;
+    while (*link != NULL && *link != heap) link = &(*link)->next_heap;
+    if (*link != NULL) *link = heap->next_heap;
+    spin_unlock(&user_heaps_lock);
+
+#if MEM_HARDENED
+    // Інакше карантин згодом торкнувся б знятої пам'яті
+    for (Arena* arena = heap->arena_list; arena != NULL; arena = arena->next) {
+        hardened_quarantine_drop(arena, arena->size);
+    }
+#endif
+    heap_reset(heap);
+    free(heap);
+}
+
+void mem_heap_set_limits(mem_heap_t* heap, size_t soft_limit, size_t hard_limit) {
+    if (heap == NULL) return;
+    heap_lock(heap);
+    heap->soft_limit = soft_limit;
+    heap->hard_limit = hard_limit;
+    heap->over_soft = false;
+    heap_unlock(heap);
+}
+
+void* mem_heap_alloc(mem_heap_t* heap, size_t size) {
+    if (heap == NULL) return NULL;
+    LATENCY_BEGIN();
+    void* ptr = heap_alloc(heap, size);
+    LATENCY_END(MEM_LAT_ALLOC);
+    if (trace_enabled) trace_record(TRACE_OP_ALLOC, ptr, NULL, size);
+    return ptr;
+}
+
+void mem_heap_free(mem_heap_t* heap, void* ptr) {
+    if (ptr == NULL) return;
+#if MEM_HARDENED
+    Arena* arena = find_arena_for_block(block_from_payload(ptr));
+    if (arena != NULL && arena->heap != heap) hardened_report("mem_heap_free of a block from another heap", ptr);
+#else
+    (void)heap;
+#endif
+    // Купу-власницю heap_free і так знаходить через заголовок арени
+    mem_free(ptr);
+}
+
+void* mem_heap_realloc(mem_heap_t* heap, void* ptr, size_t size) {
+    if (heap == NULL) return NULL;
+    uint64_t stamp = trace_enabled ? trace_clock() : 0;
+    LATENCY_BEGIN();
+    void* new_ptr = heap_realloc(heap, ptr, size);
+    LATENCY_END(MEM_LAT_REALLOC);
+    if (trace_enabled) trace_record_at(TRACE_OP_REALLOC, new_ptr, ptr, size, stamp);
+    return new_ptr;
+}
+
+// Пул часу життя створюється при першій підказці; програла гонку - знищує свій
+static Heap* lifetime_heap(unsigned hint) {
+    Heap* h = lifetime_heaps[hint];
+    if (h != NULL) return h;
+
+    Heap* created = mem_heap_create();
+    if (created == NULL) return NULL;
+    spin_lock(&user_heaps_lock);
+    h = lifetime_heaps[hint];
+    if (h == NULL) h = lifetime_heaps[hint] = created;
+    spin_unlock(&user_heaps_lock);
+    if (h != created) mem_heap_destroy(created);
+    return h;
+}
+
+void* mem_alloc_hint(size_t size, unsigned flags) {
+    unsigned hint = flags & MEM_HINT_LIFETIME_MASK;
+    if (hint == MEM_HINT_DEFAULT || hint >= MEM_HINT_COUNT || shared_mode || tlsf_mode) {
+        return mem_alloc(size);
+    }
+    Heap* h = lifetime_heap(hint);
+    if (h == NULL) return mem_alloc(size);
+
+    LATENCY_BEGIN();
+    void* ptr = heap_alloc(h, size);
+    LATENCY_END(MEM_LAT_ALLOC);
+    if (trace_enabled) trace_record(TRACE_OP_ALLOC, ptr, NULL, size);
+    return ptr;
+}
+
+void mem_lifetime_stats(unsigned hint, MemStats* stats) {
+    if (stats == NULL) return;
+    hint &= MEM_HINT_LIFETIME_MASK;
+    if (hint == MEM_HINT_DEFAULT || hint >= MEM_HINT_COUNT || shared_mode || tlsf_mode) {
+        mem_stats(stats);
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    Heap* h = lifetime_heaps[hint];
+    if (h == NULL) return;
+    heap_lock(h);
+    add_heap_stats(h, stats);
+    heap_unlock(h);
+}
+
+bool mem_init_config(const MemConfig* config) {
+    // MEM_CONF має останнє слово: так купу налаштовують без перезбирання
+    MemConfig merged;
+    if (config != NULL) {
+        merged = *config;
+    } else {
+        memset(&merged, 0, sizeof(merged));
+    }
+    conf_parse(getenv(CONF_ENV), &merged);
+    config = &merged;
+
+    if (config->page_size > 0) {
+        page_size = config->page_size;
+    } else {
+        page_size = page_os_size();
+    }
+
+    if (config->arena_size > 0) {
+        default_arena_size = config->arena_size;
+    } else {
+        default_arena_size = 4 * page_size;
+    }
+
+    // Повторна ініціалізація повертає системі все, що лишилося від попередньої
+    for (int i = 0; i < MEM_MAX_NUMA_NODES; i++) {
+        heap_reset(&heaps[i]);
+    }
+    // Створені купи теж: їхні арени вирівняні за старим розміром арени
+    while (user_heaps != NULL) {
+        Heap* next = user_heaps->next_heap;
+        heap_reset(user_heaps);
+        free(user_heaps);
+        user_heaps = next;
+    }
+    memset(lifetime_heaps, 0, sizeof(lifetime_heaps));
+
+    mem_set_limits(config->soft_limit, config->hard_limit);
+
+    os_page_size = page_os_size();
+    arena_align = os_page_size;
+    while (arena_align < default_arena_size) arena_align <<= 1;
+
+    // З NUMA - по купі на вузол; numa_nodes дозволяє емулювати більше вузлів
+    numa_enabled = config->numa;
+    numa_emulated = false;
+    heap_count = 1;
+    if (numa_enabled) {
+        int system_nodes = numa_node_count();
+        heap_count = config->numa_nodes > 0 ? config->numa_nodes : system_nodes;
+        if (heap_count > MEM_MAX_NUMA_NODES) heap_count = MEM_MAX_NUMA_NODES;
+        if (heap_count < 1) heap_count = 1;
+        numa_emulated = heap_count > system_nodes;
+    }
+
+    // Невідома політика - як нульове поле, тобто best-fit
+    policy = (unsigned)config->policy <= MEM_POLICY_GOOD_FIT ? config->policy : MEM_POLICY_BEST_FIT;
+    good_fit_percent = config->good_fit_percent > 0 ? config->good_fit_percent : MEM_GOOD_FIT_DEFAULT_PERCENT;
+    handle_table_reset();
+#if MEM_HARDENED
+    hardened_reset();
+#endif
+
+    class_cache_limit = config->class_cache_limit > 0 ? config->class_cache_limit : MEM_CLASS_CACHE_LIMIT;
+    // Межа - розмір класу, інакше блок, округлений за межу, не потрапив би в кеш
+    size_class_limit = SIZE_CLASS_MAX;
+    if (config->size_class_max > 0) {
+        size_class_limit = 0;
+        for (unsigned cls = 0; cls < SIZE_CLASS_COUNT && size_class_size[cls] <= config->size_class_max; cls++) {
+            size_class_limit = size_class_size[cls];
+        }
+    }
+    sized_free_limit = size_class_limit > block_header_size() ? size_class_limit - block_header_size() : 0;
+    purge_decay_ns = (uint64_t)config->purge_decay_ms * 1000000;
+    arena_colors = config->arena_colors > 0 ? config->arena_colors : MEM_ARENA_COLORS;
+    // Відступ не більше чверті арени, інакше звичайні арени лишалися б без кольору
+    if (arena_colors > default_arena_size / 4 / MEM_CACHE_LINE + 1) {
+        arena_colors = (unsigned)(default_arena_size / 4 / MEM_CACHE_LINE + 1);
+    }
+    buddy_chunk = MEM_BUDDY_CHUNK;
+    if (config->large_threshold > 0) {
+        buddy_chunk = arena_align;
+        while (buddy_chunk / 2 < config->large_threshold) buddy_chunk <<= 1;
+    }
+    // Попередні арени вже зняті старим постачальником
+    if (config->page_provider != NULL) {
+        pages = config->page_provider;
+    } else {
+        pages = config->huge_pages ? &page_huge : &page_mmap;
+    }
+    if (config->latency_sample > 0) mem_latency_enable(config->latency_sample);
+    if (config->trace_path != NULL && !trace_enabled) mem_trace_start(config->trace_path);
+
+    effective_config = merged;
+    effective_config.page_size = page_size;
+    effective_config.arena_size = default_arena_size;
+    effective_config.policy = policy;
+    effective_config.good_fit_percent = good_fit_percent;
+    effective_config.numa = numa_enabled;
+    effective_config.numa_nodes = heap_count;
+    effective_config.large_threshold = buddy_chunk / 2;
+    effective_config.class_cache_limit = class_cache_limit;
+    effective_config.size_class_max = size_class_limit;
+    effective_config.arena_colors = arena_colors;
+    free(effective_trace_path);
+    effective_trace_path = NULL;
+    if (config->trace_path != NULL) {
+        size_t length = strlen(config->trace_path) + 1;
+        effective_trace_path = (char*)malloc(length);
+        if (effective_trace_path != NULL) memcpy(effective_trace_path, config->trace_path, length);
+    }
+    effective_config.trace_path = effective_trace_path;
+
+    shared_close();
+    shared_mode = false;
+    tlsf_close();
+    tlsf_mode = false;
+    if (config->shared) {
+        shared_mode = shared_open(config->shared_path, config->shared_fd,
+                                  config->shared_size, default_arena_size);
+        return shared_mode;
+    }
+
+    if (config->tlsf) {
+        tlsf_mode = tlsf_open(config->tlsf_pool_size, config->tlsf_fixed, pages);
+        return tlsf_mode;
+    }
+    return true;
+}
+
+void mem_init(size_t custom_page_size, size_t custom_arena_size) {
+    MemConfig config = {0};
+    config.page_size = custom_page_size;
+    config.arena_size = custom_arena_size;
+    config.policy = MEM_POLICY_BEST_FIT;
+    mem_init_config(&config);
+}
+
+bool mem_reserve(size_t bytes, unsigned flags) {
+    // Спільна купа і TLSF мають власне попереднє відображення
+    if (shared_mode || tlsf_mode) return false;
+
+    Heap* h = current_heap();
+    size_t block_size = default_arena_size - ARENA_HEADER_SIZE;
+    size_t count = (bytes + block_size - 1) / block_size;
+    bool ok = true;
+
+    heap_lock(h);
+    // Порожні арени резерву - саме те, що знімало б очищення на м'якій межі;
+    // перетин межі лише доходить до колбека
+    h->reserving = true;
+    for (size_t i = 0; i < count; i++) {
+        // Арена з одним блоком на всю площу після відступу кольору, який одразу стає вільним
+        Block* block = new_arena(h, block_size - peek_color(h));
+        if (block == NULL) {
+            ok = false;
+            break;
+        }
+        Arena* arena = arena_of(block);
+        if (flags & MEM_RESERVE_POPULATE) {
+            // Запис того самого байта викликає збій сторінки зараз, а не в mem_alloc
+            volatile char* page = (volatile char*)arena;
+            for (size_t offset = 0; offset < arena->size; offset += os_page_size) {
+                page[offset] = page[offset];
+            }
+        }
+        if ((flags & MEM_RESERVE_LOCK) && !pages->advise(pages->ctx, arena, arena->size, PAGE_ADVICE_LOCK)) ok = false;
+
+        block_set_flag_busy(block, false);
+        add_to_free_tree(h, block_get_size(block), block);
+    }
+    h->reserving = false;
+    heap_unlock(h);
+    if (pressure_pending) notify_pressure();
+    return ok;
+}
+
+bool mem_config_parse(const char* text, MemConfig* config) {
+    if (config == NULL) return false;
+    return conf_parse(text, config);
+}
 
-    arena_list = NULL;
-    free_tree = NULL;
+void mem_config_show(void) {
+    printf("=== Effective Configuration ===\n");
+    conf_print(stdout, &effective_config);
 }
\ No newline at end of file
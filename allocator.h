@@ -2,14 +2,265 @@
 #define ALLOCATOR_H
 
 #include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Політика вибору вільного блока */
+typedef enum MemPolicy {
+    MEM_POLICY_BEST_FIT,   /* найменший придатний розмір (дерево розмірів) */
+    MEM_POLICY_FIRST_FIT,  /* найнижча придатна адреса (дерево адрес) */
+    MEM_POLICY_NEXT_FIT,   /* перший придатний після попереднього виділення */
+    MEM_POLICY_GOOD_FIT    /* перший знайдений не більший за size + N% */
+} MemPolicy;
+
+#define MEM_GOOD_FIT_DEFAULT_PERCENT 12
+
+/* Параметри ініціалізації; нульові поля означають значення за замовчуванням */
+typedef struct MemConfig {
+    size_t page_size;
+    size_t arena_size;
+    MemPolicy policy;
+    unsigned good_fit_percent;
+    /* Окрема купа на кожен NUMA-вузол; арени прив'язуються до вузла потоку */
+    bool numa;
+    /* Кількість вузлів (0 - визначити автоматично; більше - емуляція) */
+    int numa_nodes;
+    /* Купа в спільному відображенні: файл shared_path або, якщо шлях NULL,
+     * дескриптор shared_fd (наприклад, memfd). shared_size 0 - розмір
+     * наявного файлу; новий файл створюється цього розміру */
+    bool shared;
+    const char* shared_path;
+    int shared_fd;
+    size_t shared_size;
+    /* Рушій TLSF (див. tlsf.h): виділення і звільнення за сталий час у
+     * пулах по tlsf_pool_size байт (0 - 64 МіБ). tlsf_fixed - один пул,
+     * відображений і прочитаний під час mem_init_config; після цього ОС не
+     * викликається, а вичерпаний пул дає NULL. Спільна купа має пріоритет */
+    bool tlsf;
+    size_t tlsf_pool_size;
+    bool tlsf_fixed;
+    /* Межі відображеної пам'яті всіх куп разом (див. mem_set_limits) */
+    size_t soft_limit;
+    size_t hard_limit;
+    /* Великі блоки до large_threshold беруться з шматків buddy, більші -
+     * окремим відображенням (0 - половина MEM_BUDDY_CHUNK) */
+    size_t large_threshold;
+    /* Скільки звільнених блоків тримає кеш кожного класу (0 - MEM_CLASS_CACHE_LIMIT) */
+    unsigned class_cache_limit;
+    /* Найбільший блок із заголовком, що округлюється до класу і йде в кеш
+     * класів (0 - SIZE_CLASS_MAX); зменшується до межі класу, більше за
+     * SIZE_CLASS_MAX не буває */
+    size_t size_class_max;
+    /* Купа сама очищається, як mem_purge, при звільненні, якщо з останнього
+     * очищення минуло стільки мілісекунд (0 - лише під тиском і mem_purge) */
+    unsigned purge_decay_ms;
+    /* Скільки різних відступів, кратних 64 байтам, чергують перші блоки
+     * арен (0 - MEM_ARENA_COLORS, 1 - без відступу) */
+    unsigned arena_colors;
+    /* Звідки купа бере сторінки (page.h); NULL - page_mmap або, якщо
+     * huge_pages, page_huge. Діє і для пулів TLSF, але не для спільної купи */
+    const struct PageProvider* page_provider;
+    bool huge_pages;
+    /* Увімкнути mem_latency_enable(latency_sample) і mem_trace_start(trace_path) */
+    unsigned latency_sample;
+    const char* trace_path;
+} MemConfig;
+
+/* Знімок стану купи */
+typedef struct MemStats {
+    size_t arena_count;
+    size_t mapped_bytes;
+    size_t free_blocks;
+    size_t free_bytes;
+    size_t largest_free;
+    /* Великі арени, вирізані з уже відображених шматків buddy без mmap */
+    size_t mmaps_avoided;
+} MemStats;
+
+/* Лічильники купи одного NUMA-вузла */
+typedef struct MemNodeStats {
+    int node;
+    size_t arena_count;
+    size_t mapped_bytes;
+    size_t alloc_count;
+    size_t free_count;
+    /* Звільнення потоками інших вузлів; блок усе одно повертається цьому вузлу */
+    size_t remote_frees;
+    /* Відображені шматки buddy і виділення з них, що обійшлися без mmap */
+    size_t buddy_chunks;
+    size_t mmaps_avoided;
+    /* Очищення після перетину м'якої межі і відмови через жорстку */
+    size_t purges;
+    size_t limit_failures;
+} MemNodeStats;
 
 void* mem_alloc(size_t size);
+/* Скільки байт блока реально доступно (у hardened-збірці - рівно запитане) */
+size_t mem_usable_size(void* ptr);
+/* Розмір, який фактично отримає запит size; виділення під нього не дорожче */
+size_t mem_good_size(size_t size);
+/* alignment - степінь двійки, не більше половини розміру арени; звільняється mem_free */
+void* mem_alloc_aligned(size_t alignment, size_t size);
 void mem_free(void* ptr);
+/* Звільнення з розміром, переданим у mem_alloc/mem_realloc (або його
+ * mem_good_size, або mem_usable_size блока): дрібні блоки повертаються в кеш класу без читання
+ * заголовка. Hardened-збірка перевіряє, що розмір між запитаним і місткістю блока.
+ * Не для mem_alloc_aligned */
+void mem_free_sized(void* ptr, size_t size);
 void* mem_realloc(void* ptr, size_t size);
 void mem_show(void);
+/* Перевірка інваріантів купи; повертає кількість знайдених порушень */
+int mem_check(void);
+/* (Пере)ініціалізація; звільняє всі арени попереднього сеансу */
 void mem_init(size_t custom_page_size, size_t custom_arena_size);
+/* false, якщо спільну купу або пул TLSF не вдалося відобразити (купа лишається звичайною) */
+bool mem_init_config(const MemConfig* config);
+void mem_stats(MemStats* stats);
+
+/* Налаштування рядком "ключ=значення,..." (ключі - у conf.h); змінна
+ * середовища MEM_CONF у тому ж форматі накладається поверх конфігурації
+ * mem_init_config. mem_config_parse застосовує рядок до config і повертає
+ * false, якщо якусь пару не розібрано; mem_config_show друкує
+ * конфігурацію, з якою купу ініціалізовано, у тому ж форматі */
+bool mem_config_parse(const char* text, MemConfig* config);
+void mem_config_show(void);
+
+/* Прогрів купи поточного потоку: mem_reserve одразу відображає звичайні
+ * арени, разом не менше bytes байт, і кладе їх в індекс вільних блоків.
+ * Поки запити вміщаються в цей обсяг і не більші за арену, mem_alloc не
+ * звертається до ОС. POPULATE - торкнутися кожної сторінки зараз, щоб
+ * перші виділення не ловили збоїв сторінок; LOCK - ще й mlock.
+ * М'яка межа резерву не урізає (лише викликає колбек тиску).
+ * false, якщо частину арен не вдалося відобразити або закріпити
+ * (у спільному режимі і TLSF - завжди) */
+#define MEM_RESERVE_POPULATE 1u
+#define MEM_RESERVE_LOCK 2u
+bool mem_reserve(size_t bytes, unsigned flags);
+
+/* Операції та шляхи, за якими ведуться гістограми затримок */
+typedef enum MemLatencyOp {
+    MEM_LAT_ALLOC,
+    MEM_LAT_FREE,
+    MEM_LAT_REALLOC,
+    MEM_LAT_OP_COUNT
+} MemLatencyOp;
+
+typedef enum MemLatencyPath {
+    MEM_LAT_FAST,   /* кеш класу або realloc на місці */
+    MEM_LAT_TREE,   /* індекс вільних блоків */
+    MEM_LAT_ARENA,  /* нова звичайна арена */
+    MEM_LAT_LARGE,  /* окреме відображення великого блока */
+    MEM_LAT_BUDDY,  /* велика арена з шматка buddy */
+    MEM_LAT_PATH_COUNT
+} MemLatencyPath;
+
+typedef struct MemLatencySummary {
+    size_t count;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+} MemLatencySummary;
+
+typedef struct MemLatencyStats {
+    MemLatencySummary summary[MEM_LAT_OP_COUNT][MEM_LAT_PATH_COUNT];
+} MemLatencyStats;
+
+/* NUMA: кількість куп-вузлів (1 без NUMA) і лічильники кожної */
+int mem_numa_node_count(void);
+void mem_node_stats(int node, MemNodeStats* stats);
+
+/* Гістограми затримок по потоках. sample_every: 0 - вимкнено, 1 - кожна
+ * операція, N - кожна N-та; звернення до mmap/munmap вимірюються завжди */
+void mem_latency_enable(unsigned sample_every);
+void mem_latency_reset(void);
+void mem_latency_stats(MemLatencyStats* stats);
+
+/*
+ * Незалежні купи: власні арени, індекс вільних блоків, кеш класів і замок,
+ * тож купи не фрагментують одна одну і не чекають одна на одну.
+ * mem_heap_destroy повертає системі всі арени купи, не обходячи блоків.
+ * Блоки купи звільняються mem_heap_free, mem_free або mem_free_sized.
+ * mem_init знищує всі створені купи; у спільному режимі купи не створюються.
+ */
+typedef struct MemHeap mem_heap_t;
+
+mem_heap_t* mem_heap_create(void);
+void mem_heap_destroy(mem_heap_t* heap);
+void* mem_heap_alloc(mem_heap_t* heap, size_t size);
+void mem_heap_free(mem_heap_t* heap, void* ptr);
+/* ptr NULL - виділення з heap; перенесений блок лишається в heap */
+void* mem_heap_realloc(mem_heap_t* heap, void* ptr, size_t size);
+
+/*
+ * Підказки часу життя: блоки mem_alloc_hint з MEM_HINT_SHORT (буфери
+ * запиту) і MEM_HINT_LONG (записи кешу) живуть в окремих пулах арен, тож
+ * довгоживучий блок не тримає арену, повну короткоживучих. Звільняються
+ * mem_free або mem_free_sized; mem_realloc лишає блок у його пулі. Без підказки, у
+ * спільному режимі і з TLSF - те саме, що mem_alloc. mem_lifetime_stats -
+ * арени і вільні байти пулу (для MEM_HINT_DEFAULT - mem_stats).
+ */
+#define MEM_HINT_DEFAULT 0u
+#define MEM_HINT_SHORT 1u
+#define MEM_HINT_LONG 2u
+#define MEM_HINT_COUNT 3u
+#define MEM_HINT_LIFETIME_MASK 3u
+
+void* mem_alloc_hint(size_t size, unsigned flags);
+void mem_lifetime_stats(unsigned hint, MemStats* stats);
+
+/*
+ * Бюджет пам'яті, відображеної в ОС (арени і шматки buddy), - для всіх
+ * куп разом або для окремої mem_heap_t; 0 - без межі. Коли відображення
+ * нової арени переводить купу за м'яку межу, вона віддає ОС порожні арени
+ * і сторінки вільних блоків, а після зняття замка викликається колбек
+ * (heap NULL - перетнуто загальну межу; mapped - відображені байти).
+ * Наступний виклик - лише після спаду нижче межі. Нову арену понад жорстку
+ * межу mem_alloc не відображає і повертає NULL. Спільна купа і TLSF не
+ * обмежуються; mem_init_config встановлює загальні межі з конфігурації.
+ */
+typedef void (*MemPressureFn)(mem_heap_t* heap, size_t mapped, void* ctx);
+
+void mem_set_limits(size_t soft_limit, size_t hard_limit);
+void mem_heap_set_limits(mem_heap_t* heap, size_t soft_limit, size_t hard_limit);
+void mem_set_pressure_callback(MemPressureFn fn, void* ctx);
+/* Те саме очищення, що й на м'якій межі, для всіх куп одразу; повертає зняті з відображення байти */
+size_t mem_purge(void);
+/*
+ * Дескриптори переміщуваних об'єктів. Поки дескриптор не заблоковано,
+ * mem_compact може перенести дані в іншу арену; вказівник з
+ * mem_handle_lock дійсний до відповідного mem_handle_unlock.
+ */
+typedef struct MemHandleSlot* MemHandle;
+
+MemHandle mem_handle_alloc(size_t size);
+void* mem_handle_lock(MemHandle handle);
+void mem_handle_unlock(MemHandle handle);
+void mem_handle_free(MemHandle handle);
+
+/* Перенести не більше budget байт дескрипторних блоків з розріджених арен
+ * у щільніші і звільнити спорожнілі арени; повертає перенесені байти */
+size_t mem_compact(size_t budget);
+
+/* Спільна купа: корінь даних, що переживає перезапуск, і перетворення
+ * вказівників у зсуви для незалежних від адреси зв'язків (0 - NULL) */
+void* mem_shared_root(void);
+void mem_shared_set_root(void* ptr);
+size_t mem_shared_offset(void* ptr);
+void* mem_shared_ptr(size_t offset);
+
+/* Запис траси mem_alloc/mem_free/mem_realloc у файл (див. trace.h, mem_replay) */
+bool mem_trace_start(const char* path);
+void mem_trace_stop(void);
 
 extern size_t page_size;
 extern size_t default_arena_size;
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+// bench_bitmap.c - пошук вільного слота у бітовій карті: скалярно, SSE2, AVX2
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitmap.h"
+
+#define MAX_SLOTS 65536
+#define WORK (1u << 26)
+#define ROUNDS 5
+
+static const char* isa_names[BITMAP_ISA_COUNT] = {"scalar", "sse2", "avx2"};
+
+static uint64_t words[MAX_SLOTS / 64];
+static volatile size_t sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Заповнений слаб: вільний лише останній слот або кожен free_every-й випадковий
+static void fill(size_t slots, unsigned free_every) {
+    unsigned state = 777;
+    memset(words, 0xFF, sizeof(words));
+    if (free_every == 0) {
+        words[(slots - 1) / 64] &= ~((uint64_t)1 << ((slots - 1) % 64));
+        return;
+    }
+    for (size_t i = 0; i < slots; i++) {
+        state = state * 1103515245u + 12345u;
+        if ((state >> 8) % free_every == 0) words[i / 64] &= ~((uint64_t)1 << (i % 64));
+    }
+}
+
+// Пошук першого вільного слота з початку слаба, найкращий з ROUNDS; нс на виклик
+static double time_find(const BitmapKernels* k, size_t slots) {
+    size_t calls = WORK / slots;
+    double best = 1e30;
+    for (int r = 0; r < ROUNDS; r++) {
+        double start = now_ns();
+        for (size_t i = 0; i < calls; i++) sink = k->find_zero(words, slots);
+        double ns = (now_ns() - start) / (double)calls;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+static double time_count(const BitmapKernels* k, size_t slots) {
+    size_t calls = WORK / slots;
+    double best = 1e30;
+    for (int r = 0; r < ROUNDS; r++) {
+        double start = now_ns();
+        for (size_t i = 0; i < calls; i++) sink = k->count_zero(words, slots);
+        double ns = (now_ns() - start) / (double)calls;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+int main(void) {
+    static const size_t slab_sizes[] = {512, 4096, MAX_SLOTS};
+    static const unsigned patterns[] = {0, 100};
+    printf("best isa: %s\n\n", isa_names[bitmap_best_isa()]);
+    printf("%-8s %-14s %-8s %12s %12s\n", "slots", "free", "isa", "find ns", "count ns");
+    for (size_t s = 0; s < sizeof(slab_sizes) / sizeof(slab_sizes[0]); s++) {
+        for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+            fill(slab_sizes[s], patterns[p]);
+            for (int isa = 0; isa < BITMAP_ISA_COUNT; isa++) {
+                const BitmapKernels* k = bitmap_kernels_for((BitmapIsa)isa);
+                if (k == NULL) continue;
+                printf("%-8zu %-14s %-8s %12.1f %12.1f\n", slab_sizes[s],
+                       patterns[p] == 0 ? "last slot" : "~1% random",
+                       isa_names[isa], time_find(k, slab_sizes[s]), time_count(k, slab_sizes[s]));
+            }
+        }
+    }
+    return 0;
+}
\ No newline at end of file
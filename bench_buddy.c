@@ -0,0 +1,76 @@
+// bench_buddy.c - середні виділення (16 КіБ - 1 МіБ): арени з buddy проти mmap на кожне
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "allocator.h"
+
+#define LIVE 64
+#define OPS 200000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static unsigned next_random(unsigned* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 4;
+}
+
+static size_t random_size(unsigned* state) {
+    return 16 * 1024 + (size_t)(next_random(state) % (1008 * 1024));
+}
+
+// Окреме відображення на кожен блок - так великі блоки виділялися без buddy
+static void* map_block(size_t size) {
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+static double run(int use_mmap) {
+    void* live[LIVE] = {0};
+    size_t sizes[LIVE] = {0};
+    unsigned state = 7;
+
+    double start = now_ns();
+    for (int op = 0; op < OPS; op++) {
+        int slot = (int)(next_random(&state) % LIVE);
+        if (live[slot] != NULL) {
+            if (use_mmap) munmap(live[slot], sizes[slot]);
+            else mem_free(live[slot]);
+        }
+        sizes[slot] = random_size(&state);
+        live[slot] = use_mmap ? map_block(sizes[slot]) : mem_alloc(sizes[slot]);
+        // Перша сторінка торкається, як це зробив би користувач
+        *(volatile char*)live[slot] = 1;
+    }
+    double elapsed = now_ns() - start;
+
+    for (int i = 0; i < LIVE; i++) {
+        if (live[i] == NULL) continue;
+        if (use_mmap) munmap(live[i], sizes[i]);
+        else mem_free(live[i]);
+    }
+    return elapsed / OPS;
+}
+
+int main(void) {
+    mem_init(4096, 64 * 1024);
+    double mmap_ns = run(1);
+    double buddy_ns = run(0);
+
+    MemStats stats;
+    MemNodeStats node;
+    mem_stats(&stats);
+    mem_node_stats(0, &node);
+
+    printf("%-8s %12s\n", "mode", "ns/op");
+    printf("%-8s %12.1f\n", "mmap", mmap_ns);
+    printf("%-8s %12.1f\n", "buddy", buddy_ns);
+    printf("mmaps avoided: %zu of %d, buddy chunks mapped now: %zu\n",
+           stats.mmaps_avoided, OPS, node.buddy_chunks);
+    return 0;
+}
\ No newline at end of file
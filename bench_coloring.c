@@ -0,0 +1,133 @@
+// bench_coloring.c - обхід перших дрібних об'єктів багатьох арен з кольорами і без:
+// промахи кешу (perf_event_open) і час на звернення
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "allocator.h"
+
+#define ARENA_SIZE (16 * 1024)
+#define ARENAS 1024
+#define PER_ARENA 2
+#define OBJECT_SIZE 48
+#define PASSES 200
+
+// Об'єкти, що лежать першими в своїх аренах, - як голови списків чи лічильники арени
+static volatile uint64_t* hot[ARENAS * PER_ARENA];
+static void* all[ARENAS * (ARENA_SIZE / OBJECT_SIZE)];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+typedef struct Counter {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+    int fd;
+} Counter;
+
+#define L1D_READ_MISS (PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static Counter counters[] = {
+    {"L1d miss", PERF_TYPE_HW_CACHE, L1D_READ_MISS, -1},
+    {"LLC ref", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, -1},
+    {"LLC miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1},
+};
+#define COUNTER_COUNT (sizeof(counters) / sizeof(counters[0]))
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Заповнити ARENAS арен дрібними об'єктами і запам'ятати перші PER_ARENA у кожній
+static size_t fill(unsigned colors) {
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.arena_size = ARENA_SIZE;
+    config.arena_colors = colors;
+    mem_init_config(&config);
+
+    size_t count = 0, arenas = 0, in_arena = 0;
+    uintptr_t current = 0;
+    while (arenas < ARENAS || in_arena < PER_ARENA) {
+        void* p = mem_alloc(OBJECT_SIZE);
+        all[count++] = p;
+        uintptr_t arena = (uintptr_t)p & ~(uintptr_t)(ARENA_SIZE - 1);
+        if (arena != current) {
+            if (arenas == ARENAS) break;
+            current = arena;
+            arenas++;
+            in_arena = 0;
+        }
+        if (in_arena < PER_ARENA) hot[(arenas - 1) * PER_ARENA + in_arena++] = (volatile uint64_t*)p;
+    }
+    return count;
+}
+
+static void run(const char* name, unsigned colors) {
+    size_t count = fill(colors);
+    uint64_t values[COUNTER_COUNT] = {0};
+
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        if (counters[c].fd < 0) continue;
+        ioctl(counters[c].fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters[c].fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    double start = now_ns();
+    uint64_t sum = 0;
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (size_t i = 0; i < ARENAS * PER_ARENA; i++) sum += (*hot[i])++;
+    }
+    double ns = (now_ns() - start) / ((double)PASSES * ARENAS * PER_ARENA);
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        if (counters[c].fd < 0) continue;
+        ioctl(counters[c].fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counters[c].fd, &values[c], sizeof(values[c])) != sizeof(values[c])) values[c] = 0;
+    }
+
+    printf("%-10s %8.2f", name, ns);
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        if (counters[c].fd < 0) printf(" %10s", "n/a");
+        else printf(" %10.3f", (double)values[c] / ((double)PASSES * ARENAS * PER_ARENA));
+    }
+    printf("   (sum %llu)\n", (unsigned long long)sum);
+
+    for (size_t i = 0; i < count; i++) mem_free(all[i]);
+}
+
+int main(void) {
+    bool any = false;
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        counters[c].fd = open_counter(counters[c].type, counters[c].config);
+        if (counters[c].fd >= 0) any = true;
+    }
+    if (!any) printf("perf_event_open unavailable (perf_event_paranoid?), timing only\n");
+
+    printf("%d arenas of %d bytes, first %d objects of %d bytes each, %d passes\n",
+           ARENAS, ARENA_SIZE, PER_ARENA, OBJECT_SIZE, PASSES);
+    printf("%-10s %8s", "colors", "ns/touch");
+    for (size_t c = 0; c < COUNTER_COUNT; c++) printf(" %10s", counters[c].name);
+    printf("   per touch\n");
+    run("1 (off)", 1);
+    run("4", 4);
+    run("8", 8);
+    run("16", 16);
+    mem_init(4096, ARENA_SIZE);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+// bench_fastpath.c - такти процесора на пару mem_alloc/mem_free, з гістограмами затримок і без
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "allocator.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t cycles(void) { return __rdtsc(); }
+#define CYCLE_UNIT "cycles"
+#else
+static uint64_t cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#define CYCLE_UNIT "ns"
+#endif
+
+#define PAIRS 1000000
+#define BATCH 64
+
+// Одна пара виділення/звільнення того самого розміру
+static double single_pair(size_t size) {
+    uint64_t start = cycles();
+    for (int i = 0; i < PAIRS; i++) {
+        void* p = mem_alloc(size);
+        *(volatile char*)p = 1;
+        mem_free(p);
+    }
+    return (double)(cycles() - start) / PAIRS;
+}
+
+// Пачка виділень, потім пачка звільнень у зворотному порядку
+static double batch_pairs(size_t size) {
+    void* ptrs[BATCH];
+    uint64_t start = cycles();
+    for (int i = 0; i < PAIRS / BATCH; i++) {
+        for (int j = 0; j < BATCH; j++) ptrs[j] = mem_alloc(size + (size_t)(j & 3) * 8);
+        for (int j = BATCH - 1; j >= 0; j--) mem_free(ptrs[j]);
+    }
+    return (double)(cycles() - start) / ((PAIRS / BATCH) * BATCH);
+}
+
+int main(void) {
+    static const size_t sizes[] = {16, 64, 256, 1000, 3000};
+
+    mem_init(4096, 256 * 1024);
+    printf("%8s %16s %16s %16s %16s\n", "size", "single " CYCLE_UNIT, "batch " CYCLE_UNIT,
+           "hist 1/1", "hist 1/64");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        double single = single_pair(sizes[i]);
+        double batch = batch_pairs(sizes[i]);
+        // Те саме з гістограмами: кожна операція і кожна 64-та
+        mem_latency_enable(1);
+        double every = single_pair(sizes[i]);
+        mem_latency_enable(64);
+        double sampled = single_pair(sizes[i]);
+        mem_latency_enable(0);
+        printf("%8zu %16.1f %16.1f %16.1f %16.1f\n", sizes[i], single, batch, every, sampled);
+    }
+
+    static const char* const ops[MEM_LAT_OP_COUNT] = {"alloc", "free", "realloc"};
+    static const char* const paths[MEM_LAT_PATH_COUNT] = {"fast", "tree", "arena", "large", "buddy"};
+    MemLatencyStats stats;
+    mem_latency_stats(&stats);
+    printf("\n%-8s %-6s %10s %10s %10s %10s %12s\n", "op", "path", "count", "p50 ns", "p99 ns", "p999 ns", "max ns");
+    for (int op = 0; op < MEM_LAT_OP_COUNT; op++) {
+        for (int path = 0; path < MEM_LAT_PATH_COUNT; path++) {
+            MemLatencySummary* s = &stats.summary[op][path];
+            if (s->count == 0) continue;
+            printf("%-8s %-6s %10zu %10.0f %10.0f %10.0f %12.0f\n", ops[op], paths[path],
+                   s->count, s->p50_ns, s->p99_ns, s->p999_ns, s->max_ns);
+        }
+    }
+    return 0;
+}
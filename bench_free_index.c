@@ -0,0 +1,122 @@
+// bench_free_index.c - пошук best-fit в AVL (tree.c) проти B+-дерева (btree.c)
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "tree.h"
+#include "btree.h"
+
+#define LOOKUPS 2000000
+#define CHURN 1000000
+#define ROUNDS 3
+
+static volatile uintptr_t sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static unsigned next_random(unsigned* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 4;
+}
+
+// Розміри вільних блоків - кратні 16 від 32 байт до 64 КіБ
+static size_t random_size(unsigned* state) {
+    return 32 + (size_t)(next_random(state) % 4096) * 16;
+}
+
+// Той самий спуск, що й find_by_size у allocator.c
+static void* avl_lower_bound(struct Node* current, size_t size) {
+    struct Node* best = NULL;
+    while (current != NULL) {
+        if (current->key >= size) {
+            best = current;
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    return best ? best->data : NULL;
+}
+
+typedef struct Result {
+    double lookup_ns;
+    double churn_ns;
+} Result;
+
+// Вставки в перемішаному порядку, щоб вузли AVL були розкидані в пам'яті,
+// як у купі, що довго працює
+static Result run(size_t n, int use_btree) {
+    size_t* keys = (size_t*)malloc(n * sizeof(size_t));
+    unsigned state = 99;
+    struct Node* avl = NULL;
+    BTree bt = {NULL, 0};
+
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = random_size(&state);
+        void* data = (void*)(uintptr_t)((i + 1) * 64);
+        if (use_btree) btree_insert(&bt, keys[i], data);
+        else avl = node_insert(avl, keys[i], data);
+    }
+
+    Result r = {1e30, 1e30};
+    for (int round = 0; round < ROUNDS; round++) {
+        state = 7;
+        double start = now_ns();
+        for (int i = 0; i < LOOKUPS; i++) {
+            size_t size = random_size(&state);
+            sink = (uintptr_t)(use_btree ? btree_lower_bound(&bt, size, NULL) : avl_lower_bound(avl, size));
+        }
+        double ns = (now_ns() - start) / LOOKUPS;
+        if (ns < r.lookup_ns) r.lookup_ns = ns;
+
+        // Заміна випадкового запису: видалення пари і вставка нового розміру
+        start = now_ns();
+        for (int i = 0; i < CHURN; i++) {
+            size_t slot = next_random(&state) % n;
+            void* data = (void*)(uintptr_t)((slot + 1) * 64);
+            size_t size = random_size(&state);
+            if (use_btree) {
+                btree_remove(&bt, keys[slot], data);
+                btree_insert(&bt, size, data);
+            } else {
+                avl = node_remove_exact(avl, keys[slot], data);
+                avl = node_insert(avl, size, data);
+            }
+            keys[slot] = size;
+        }
+        ns = (now_ns() - start) / CHURN;
+        if (ns < r.churn_ns) r.churn_ns = ns;
+    }
+
+    if (use_btree) {
+        if (btree_check(&bt) != 0 || bt.count != n) {
+            fprintf(stderr, "B+ tree invariants violated\n");
+            exit(1);
+        }
+        btree_destroy(&bt);
+    } else {
+        if (node_check(avl) != 0) {
+            fprintf(stderr, "AVL invariants violated\n");
+            exit(1);
+        }
+        node_destroy(avl);
+    }
+    free(keys);
+    return r;
+}
+
+int main(void) {
+    static const size_t counts[] = {1000, 10000, 100000, 1000000};
+    printf("%-10s %-6s %14s %16s\n", "free", "index", "lookup ns", "remove+insert ns");
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        Result avl = run(counts[i], 0);
+        Result bt = run(counts[i], 1);
+        printf("%-10zu %-6s %14.1f %16.1f\n", counts[i], "avl", avl.lookup_ns, avl.churn_ns);
+        printf("%-10zu %-6s %14.1f %16.1f\n", counts[i], "b+", bt.lookup_ns, bt.churn_ns);
+    }
+    return 0;
+}
\ No newline at end of file
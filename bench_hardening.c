@@ -0,0 +1,56 @@
+// bench_hardening.c - вартість hardened-режиму на змішаному навантаженні
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "allocator.h"
+#include "block.h"
+#include "hardened.h"
+
+#define SLOTS 512
+#define OPS 2000000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static const char* mode_name(void) {
+#if MEM_HARDENED && MEM_QUARANTINE_SLOTS > 0
+    return "hardened+quarantine";
+#elif MEM_HARDENED
+    return "hardened";
+#else
+    return "release";
+#endif
+}
+
+int main(void) {
+    static void* slots[SLOTS];
+    unsigned int seed = 12345;
+
+    mem_init(4096, 64 * 1024);
+    memset(slots, 0, sizeof(slots));
+
+    double start = now_ns();
+    for (int i = 0; i < OPS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned int slot = (seed >> 8) % SLOTS;
+        if (slots[slot] != NULL) {
+            mem_free(slots[slot]);
+            slots[slot] = NULL;
+        } else {
+            size_t size = 16 + ((seed >> 20) % 496);
+            slots[slot] = mem_alloc(size);
+            if (slots[slot] != NULL) memset(slots[slot], 0x5A, size < 64 ? size : 64);
+        }
+    }
+    double elapsed = now_ns() - start;
+
+    for (int i = 0; i < SLOTS; i++) mem_free(slots[i]);
+
+    printf("mode=%-20s header=%zu ops=%d ns/op=%.1f\n",
+           mode_name(), block_header_size(), OPS, elapsed / OPS);
+    return 0;
+}
@@ -0,0 +1,85 @@
+// bench_lifetime.c - змішане навантаження: буфери запитів і записи кешу з підказками часу життя і без
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+#define WAVES 20
+#define BURST 4000
+#define CACHE 4000
+
+static unsigned next_random(unsigned* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 4;
+}
+
+static void* cache[CACHE];
+static void* buffers[BURST];
+
+// Резидентна пам'ять процесу з /proc (0, якщо недоступно)
+static size_t resident_kib(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return 0;
+    unsigned long total = 0, resident = 0;
+    if (fscanf(f, "%lu %lu", &total, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * 4;
+}
+
+static size_t mapped_bytes(bool hinted) {
+    MemStats stats;
+    mem_stats(&stats);
+    size_t mapped = stats.mapped_bytes;
+    for (unsigned hint = MEM_HINT_SHORT; hinted && hint < MEM_HINT_COUNT; hint++) {
+        mem_lifetime_stats(hint, &stats);
+        mapped += stats.mapped_bytes;
+    }
+    return mapped;
+}
+
+// Хвиля запитів тримає BURST буферів одночасно; кожен восьмий запит
+// оновлює випадковий запис кешу. Після хвилі буфери звільняються, а купа
+// очищується: лишається те, що тримає кеш
+static void run(const char* name, bool hinted) {
+    mem_init(4096, 64 * 1024);
+    memset(cache, 0, sizeof(cache));
+    unsigned short_hint = hinted ? MEM_HINT_SHORT : MEM_HINT_DEFAULT;
+    unsigned long_hint = hinted ? MEM_HINT_LONG : MEM_HINT_DEFAULT;
+    unsigned state = 5;
+    size_t rss_before = resident_kib();
+    size_t steady = 0;
+
+    for (int wave = 0; wave < WAVES; wave++) {
+        for (int i = 0; i < BURST; i++) {
+            buffers[i] = mem_alloc_hint(64 + next_random(&state) % 2048, short_hint);
+            memset(buffers[i], 1, 64);
+            if (i % 8 == 0) {
+                unsigned slot = next_random(&state) % CACHE;
+                mem_free(cache[slot]);
+                cache[slot] = mem_alloc_hint(32 + next_random(&state) % 256, long_hint);
+            }
+        }
+        for (int i = 0; i < BURST; i++) mem_free(buffers[i]);
+        mem_purge();
+        steady += mapped_bytes(hinted);
+    }
+
+    printf("%-8s %12zu KiB %12zu KiB\n", name, steady / WAVES / 1024, resident_kib() - rss_before);
+    if (hinted) {
+        for (unsigned hint = MEM_HINT_SHORT; hint < MEM_HINT_COUNT; hint++) {
+            MemStats part;
+            mem_lifetime_stats(hint, &part);
+            printf("  %-6s %6zu arenas, %5.1f%% occupied\n", hint == MEM_HINT_SHORT ? "short" : "long",
+                   part.arena_count,
+                   part.mapped_bytes ? 100.0 * (double)(part.mapped_bytes - part.free_bytes) / (double)part.mapped_bytes : 0.0);
+        }
+    }
+    for (int i = 0; i < CACHE; i++) mem_free(cache[i]);
+}
+
+int main(void) {
+    printf("%-8s %16s %16s\n", "mode", "mapped after wave", "rss growth");
+    run("plain", false);
+    run("hinted", true);
+    return 0;
+}
\ No newline at end of file
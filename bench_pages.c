@@ -0,0 +1,69 @@
+// bench_pages.c - ціна звернень до ОС: той самий цикл через постачальника сторінок з
+// лічильником і штучною затримкою, а також з наперед виділеного буфера
+#include <stdio.h>
+#include <time.h>
+#include "allocator.h"
+#include "page.h"
+
+#define ROUNDS 200
+#define BLOCKS 256
+#define BLOCK_SIZE (48 * 1024)
+
+static void* blocks[BLOCKS];
+static char buffer[32 * 1024 * 1024];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Кожен раунд заповнює і спорожнює купу, а mem_purge віддає порожні арени ОС
+static double churn(const PageProvider* pages) {
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.arena_size = 64 * 1024;
+    config.page_provider = pages;
+    mem_init_config(&config);
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < BLOCKS; i++) {
+            blocks[i] = mem_alloc(BLOCK_SIZE);
+            *(volatile char*)blocks[i] = 1;
+        }
+        for (int i = 0; i < BLOCKS; i++) mem_free(blocks[i]);
+        mem_purge();
+    }
+    double ns = (now_ns() - start) / ((double)ROUNDS * BLOCKS);
+    mem_init(4096, 64 * 1024);
+    return ns;
+}
+
+static void run_counting(const char* name, const PageProvider* inner, uint64_t delay_ns) {
+    PageCounting pc;
+    page_counting_init(&pc, inner, delay_ns);
+    double ns = churn(&pc.provider);
+    size_t calls = 0;
+    uint64_t os_ns = 0;
+    for (int op = 0; op < PAGE_OP_COUNT; op++) {
+        calls += pc.calls[op];
+        os_ns += pc.total_ns[op];
+    }
+    printf("%-14s %8llu %10.0f %10zu %10zu %9.1f%%\n", name, (unsigned long long)delay_ns, ns,
+           pc.calls[PAGE_OP_RESERVE], calls,
+           100.0 * (double)os_ns / (ns * ROUNDS * BLOCKS));
+}
+
+int main(void) {
+    printf("%d rounds x %d blocks of %d bytes\n", ROUNDS, BLOCKS, BLOCK_SIZE);
+    printf("%-14s %8s %10s %10s %10s %10s\n", "provider", "delay ns", "ns/op", "reserves",
+           "calls", "in pages");
+    run_counting("mmap", &page_mmap, 0);
+    run_counting("mmap", &page_mmap, 1000);
+    run_counting("mmap", &page_mmap, 10000);
+    run_counting("huge", &page_huge, 0);
+
+    PageStatic st;
+    if (page_static_init(&st, buffer, sizeof(buffer))) run_counting("static", &st.provider, 0);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+// bench_policies.c - матриця політик розміщення на однакових трасах
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "allocator.h"
+
+#define TRACE_OPS 400000
+#define TRACE_SLOTS 4096
+
+typedef struct TraceOp {
+    unsigned slot;
+    size_t size;  // 0 - звільнення слота
+} TraceOp;
+
+typedef struct Trace {
+    const char* name;
+    TraceOp* ops;
+    size_t count;
+} Trace;
+
+static unsigned int rng_state;
+
+static unsigned int rng(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+// Розмір з логарифмічним розподілом у [lo, hi]
+static size_t log_size(size_t lo, size_t hi) {
+    size_t size = lo << (rng() % 10);
+    if (size > hi) size = hi;
+    return size + rng() % size;
+}
+
+static Trace make_trace(const char* name, int kind) {
+    Trace t = {name, (TraceOp*)malloc(TRACE_OPS * sizeof(TraceOp)), 0};
+    static char live[TRACE_SLOTS];
+    memset(live, 0, sizeof(live));
+    rng_state = 777u + (unsigned)kind;
+
+    for (size_t i = 0; i < TRACE_OPS; i++) {
+        unsigned slot;
+        size_t size;
+        switch (kind) {
+        case 0:
+            // Рівномірно випадкові дрібні блоки
+            slot = rng() % TRACE_SLOTS;
+            size = 16 + rng() % 496;
+            break;
+        case 1:
+            // Змішані розміри; слоти, кратні восьми, звільняються рідко
+            slot = rng() % TRACE_SLOTS;
+            if (live[slot] && slot % 8 == 0 && rng() % 16 != 0) continue;
+            size = log_size(16, 4000);
+            break;
+        default: {
+            // Фази: наповнення, звільнення кожного другого, наповнення більшими
+            size_t round = i / TRACE_SLOTS;
+            slot = (unsigned)(i % TRACE_SLOTS);
+            if (live[slot] && (round % 2 == 0 || slot % 2 != 0)) continue;
+            size = 32 + (round % 7) * 48;
+            break;
+        }
+        }
+        t.ops[t.count].slot = slot;
+        t.ops[t.count].size = live[slot] ? 0 : size;
+        live[slot] = !live[slot];
+        t.count++;
+    }
+    return t;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void run(const Trace* t, MemPolicy policy, const char* policy_name) {
+    static void* ptrs[TRACE_SLOTS];
+    static size_t sizes[TRACE_SLOTS];
+    MemConfig config = {4096, 64 * 1024, policy, 0};
+    size_t live = 0;
+    size_t peak_live = 0;
+
+    mem_init_config(&config);
+    memset(ptrs, 0, sizeof(ptrs));
+
+    double start = now_ns();
+    for (size_t i = 0; i < t->count; i++) {
+        const TraceOp* op = &t->ops[i];
+        if (op->size == 0) {
+            mem_free(ptrs[op->slot]);
+            ptrs[op->slot] = NULL;
+            live -= sizes[op->slot];
+        } else {
+            ptrs[op->slot] = mem_alloc(op->size);
+            sizes[op->slot] = op->size;
+            live += op->size;
+            if (live > peak_live) peak_live = live;
+        }
+    }
+    double elapsed = now_ns() - start;
+
+    MemStats st;
+    mem_stats(&st);
+    double utilization = st.mapped_bytes ? (double)live / (double)st.mapped_bytes : 0.0;
+    double external = st.free_bytes ? 1.0 - (double)st.largest_free / (double)st.free_bytes : 0.0;
+
+    printf("%-8s %-10s %8.1f %10zu %10zu %8.3f %8.3f\n",
+           t->name, policy_name, elapsed / (double)t->count,
+           st.mapped_bytes / 1024, peak_live / 1024, utilization, external);
+
+    for (int i = 0; i < TRACE_SLOTS; i++) mem_free(ptrs[i]);
+}
+
+int main(void) {
+    Trace traces[3] = {
+        make_trace("uniform", 0),
+        make_trace("mixed", 1),
+        make_trace("phased", 2),
+    };
+    struct { MemPolicy policy; const char* name; } policies[] = {
+        {MEM_POLICY_BEST_FIT, "best-fit"},
+        {MEM_POLICY_FIRST_FIT, "first-fit"},
+        {MEM_POLICY_NEXT_FIT, "next-fit"},
+        {MEM_POLICY_GOOD_FIT, "good-fit"},
+    };
+
+    printf("%-8s %-10s %8s %10s %10s %8s %8s\n",
+           "trace", "policy", "ns/op", "mappedKiB", "peakKiB", "util", "extfrag");
+    for (int t = 0; t < 3; t++) {
+        for (int p = 0; p < 4; p++) {
+            run(&traces[t], policies[p].policy, policies[p].name);
+        }
+        free(traces[t].ops);
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// bench_reserve.c - затримка перших N виділень після mem_init: холодна купа проти mem_reserve
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "allocator.h"
+
+#define FIRST 20000
+#define RESERVE (8 * 1024 * 1024)
+
+static double alloc_ns[FIRST];
+static void* blocks[FIRST];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static long minor_faults(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, double p) {
+    return sorted[(size_t)(p * (FIRST - 1))];
+}
+
+// Перші FIRST запитів по 16-512 байт, кожен записується, як це робив би сервіс
+static void run(const char* name, unsigned flags, bool reserve) {
+    mem_init(4096, 64 * 1024);
+    if (reserve && !mem_reserve(RESERVE, flags)) printf("%s: mem_reserve failed (RLIMIT_MEMLOCK?)\n", name);
+    MemStats before;
+    mem_stats(&before);
+
+    unsigned state = 11;
+    long faults = minor_faults();
+    for (int i = 0; i < FIRST; i++) {
+        state = state * 1103515245u + 12345u;
+        size_t size = 16 + (state >> 8) % 497;
+        double start = now_ns();
+        blocks[i] = mem_alloc(size);
+        *(volatile char*)blocks[i] = 1;
+        alloc_ns[i] = now_ns() - start;
+    }
+    faults = minor_faults() - faults;
+
+    MemStats after;
+    mem_stats(&after);
+    qsort(alloc_ns, FIRST, sizeof(double), compare_doubles);
+    printf("%-16s %8.0f %8.0f %10.0f %8ld %8zu\n", name, percentile(alloc_ns, 0.5),
+           percentile(alloc_ns, 0.99), alloc_ns[FIRST - 1], faults,
+           after.arena_count - before.arena_count);
+
+    for (int i = 0; i < FIRST; i++) mem_free(blocks[i]);
+}
+
+int main(void) {
+    printf("first %d allocations\n", FIRST);
+    printf("%-16s %8s %8s %10s %8s %8s\n", "mode", "p50 ns", "p99 ns", "max ns", "faults", "mmaps");
+    run("cold", 0, false);
+    run("reserve", 0, true);
+    run("reserve+populate", MEM_RESERVE_POPULATE, true);
+    run("reserve+lock", MEM_RESERVE_POPULATE | MEM_RESERVE_LOCK, true);
+    return 0;
+}
\ No newline at end of file
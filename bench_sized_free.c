@@ -0,0 +1,64 @@
+// bench_sized_free.c - mem_free проти mem_free_sized на потоці дрібних об'єктів
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "allocator.h"
+
+#define LIVE 4096
+#define OPS 4000000
+#define ROUNDS 5
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Випадкова заміна живих об'єктів розміром 8..256 байт; нс на пару free+alloc
+static double churn(int sized) {
+    static void* ptrs[LIVE];
+    static size_t sizes[LIVE];
+    unsigned state = 12345;
+
+    mem_init(4096, 256 * 1024);
+    for (int i = 0; i < LIVE; i++) {
+        sizes[i] = 8 + (i * 37) % 249;
+        ptrs[i] = mem_alloc(sizes[i]);
+    }
+
+    double start = now_ns();
+    for (int i = 0; i < OPS; i++) {
+        state = state * 1103515245u + 12345u;
+        unsigned slot = (state >> 8) % LIVE;
+        if (sized) {
+            mem_free_sized(ptrs[slot], sizes[slot]);
+        } else {
+            mem_free(ptrs[slot]);
+        }
+        sizes[slot] = 8 + (state >> 20) % 249;
+        ptrs[slot] = mem_alloc(sizes[slot]);
+        *(volatile char*)ptrs[slot] = 1;
+    }
+    double elapsed = now_ns() - start;
+
+    for (int i = 0; i < LIVE; i++) mem_free_sized(ptrs[i], sizes[i]);
+    if (mem_check() != 0) {
+        fprintf(stderr, "heap invariants violated\n");
+        exit(1);
+    }
+    return elapsed / OPS;
+}
+
+int main(void) {
+    double plain = 1e30, sized = 1e30;
+    for (int r = 0; r < ROUNDS; r++) {
+        double a = churn(0);
+        double b = churn(1);
+        if (a < plain) plain = a;
+        if (b < sized) sized = b;
+    }
+    printf("small-object churn, %d live, %d ops\n", LIVE, OPS);
+    printf("  mem_free        %8.1f ns/pair\n", plain);
+    printf("  mem_free_sized  %8.1f ns/pair\n", sized);
+    return 0;
+}
\ No newline at end of file
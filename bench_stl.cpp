@@ -0,0 +1,91 @@
+// bench_stl.cpp - STL-контейнери на std::allocator, mem::allocator і mem::resource (pmr)
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include "mem_resource.hpp"
+
+#define ROUNDS 5
+#define VECTOR_ROUNDS 2000
+#define VECTOR_LEN 1000
+#define MAP_KEYS 100000
+
+// Простий LCG, щоб ключі були однакові для всіх алокаторів
+static unsigned next_key(unsigned* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+template <class Vector>
+static long vector_workload(Vector proto) {
+    long sum = 0;
+    for (int r = 0; r < VECTOR_ROUNDS; r++) {
+        Vector v(proto.get_allocator());
+        for (int i = 0; i < VECTOR_LEN; i++) v.push_back(i);
+        sum += (long)v.size();
+    }
+    return sum;
+}
+
+template <class Map>
+static long map_workload(Map m) {
+    unsigned state = 1;
+    for (int i = 0; i < MAP_KEYS; i++) m[(int)next_key(&state)] = i;
+    long sum = (long)m.size();
+    state = 1;
+    for (int i = 0; i < MAP_KEYS; i += 2) {
+        m.erase((int)next_key(&state));
+        next_key(&state);
+    }
+    return sum + (long)m.size();
+}
+
+// Найкращий час з ROUNDS повторів, мс
+template <class F>
+static double best_ms(F f) {
+    double best = 1e30;
+    volatile long sink = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        sink = sink + f();
+        std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+        if (d.count() < best) best = d.count();
+    }
+    return best;
+}
+
+int main() {
+    mem_init(0, 256 * 1024);
+    mem::resource* res = mem::default_resource();
+
+    using MemVector = std::vector<int, mem::allocator<int>>;
+    using MemUMap = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                       mem::allocator<std::pair<const int, int>>>;
+    using MemMap = std::map<int, int, std::less<int>, mem::allocator<std::pair<const int, int>>>;
+
+    printf("%-16s %14s %14s %14s\n", "workload", "std (ms)", "mem (ms)", "pmr mem (ms)");
+
+    printf("%-16s %14.2f %14.2f %14.2f\n", "vector",
+           best_ms([] { return vector_workload(std::vector<int>()); }),
+           best_ms([] { return vector_workload(MemVector()); }),
+           best_ms([res] { return vector_workload(std::pmr::vector<int>(res)); }));
+
+    printf("%-16s %14.2f %14.2f %14.2f\n", "unordered_map",
+           best_ms([] { return map_workload(std::unordered_map<int, int>()); }),
+           best_ms([] { return map_workload(MemUMap()); }),
+           best_ms([res] { return map_workload(std::pmr::unordered_map<int, int>(res)); }));
+
+    printf("%-16s %14.2f %14.2f %14.2f\n", "map",
+           best_ms([] { return map_workload(std::map<int, int>()); }),
+           best_ms([] { return map_workload(MemMap()); }),
+           best_ms([res] { return map_workload(std::pmr::map<int, int>(res)); }));
+
+    MemStats stats;
+    mem_stats(&stats);
+    printf("after run: %lu arenas, %lu bytes mapped\n",
+           (unsigned long)stats.arena_count, (unsigned long)stats.mapped_bytes);
+    return mem_check() == 0 ? 0 : 1;
+}
\ No newline at end of file
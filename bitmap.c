@@ -0,0 +1,239 @@
+#include "bitmap.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BITMAP_X86 1
+#include <immintrin.h>
+#else
+#define BITMAP_X86 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+static unsigned ctz64(uint64_t v) {
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (unsigned)index;
+}
+static unsigned popcount64(uint64_t v) {
+    return (unsigned)__popcnt64(v);
+}
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+static unsigned ctz64(uint64_t v) {
+    return (unsigned)__builtin_ctzll(v);
+}
+static unsigned popcount64(uint64_t v) {
+    return (unsigned)__builtin_popcountll(v);
+}
+#endif
+
+// Маска значущих бітів неповного останнього слова
+static uint64_t tail_mask(size_t nbits) {
+    return ((uint64_t)1 << (nbits % 64)) - 1;
+}
+
+// Скалярні ядра; SIMD-версії доходять ними від слова from до кінця
+
+static size_t find_zero_from(const uint64_t* words, size_t nbits, size_t from) {
+    size_t full = nbits / 64;
+    for (size_t i = from; i < full; i++) {
+        if (words[i] != ~(uint64_t)0) return i * 64 + ctz64(~words[i]);
+    }
+    if (nbits % 64 != 0) {
+        uint64_t z = ~words[full] & tail_mask(nbits);
+        if (z != 0) return full * 64 + ctz64(z);
+    }
+    return BITMAP_NONE;
+}
+
+static size_t find_set_from(const uint64_t* words, size_t nbits, size_t from) {
+    size_t full = nbits / 64;
+    for (size_t i = from; i < full; i++) {
+        if (words[i] != 0) return i * 64 + ctz64(words[i]);
+    }
+    if (nbits % 64 != 0) {
+        uint64_t s = words[full] & tail_mask(nbits);
+        if (s != 0) return full * 64 + ctz64(s);
+    }
+    return BITMAP_NONE;
+}
+
+static size_t count_set_from(const uint64_t* words, size_t nbits, size_t from) {
+    size_t full = nbits / 64;
+    size_t count = 0;
+    for (size_t i = from; i < full; i++) count += popcount64(words[i]);
+    if (nbits % 64 != 0) count += popcount64(words[full] & tail_mask(nbits));
+    return count;
+}
+
+static size_t scalar_find_zero(const uint64_t* words, size_t nbits) {
+    return find_zero_from(words, nbits, 0);
+}
+
+static size_t scalar_find_set(const uint64_t* words, size_t nbits) {
+    return find_set_from(words, nbits, 0);
+}
+
+static size_t scalar_count_zero(const uint64_t* words, size_t nbits) {
+    return nbits - count_set_from(words, nbits, 0);
+}
+
+#if BITMAP_X86
+
+// SSE2: по 4 слова за крок, порівняння 32-бітними частинами
+static size_t sse2_find_zero(const uint64_t* words, size_t nbits) {
+    size_t full = nbits / 64;
+    size_t i = 0;
+    __m128i ones = _mm_set1_epi32(-1);
+    for (; i + 4 <= full; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(words + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(words + i + 2));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(a, b), ones)) != 0xFFFF) break;
+    }
+    return find_zero_from(words, nbits, i);
+}
+
+static size_t sse2_find_set(const uint64_t* words, size_t nbits) {
+    size_t full = nbits / 64;
+    size_t i = 0;
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= full; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(words + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(words + i + 2));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_or_si128(a, b), zero)) != 0xFFFF) break;
+    }
+    return find_set_from(words, nbits, i);
+}
+
+// SWAR-підрахунок у 128-бітних регістрах, суми байтів - через psadbw
+static size_t sse2_count_zero(const uint64_t* words, size_t nbits) {
+    size_t full = nbits / 64;
+    size_t i = 0;
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 2 <= full; i += 2) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(words + i));
+        x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+        x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+        x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(x, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    return nbits - (size_t)(lanes[0] + lanes[1]) - count_set_from(words, nbits, i);
+}
+
+// AVX2: по 8 слів за крок
+TARGET_AVX2 static size_t avx2_find_zero(const uint64_t* words, size_t nbits) {
+    size_t full = nbits / 64;
+    size_t i = 0;
+    __m256i ones = _mm256_set1_epi64x(-1);
+    for (; i + 8 <= full; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(words + i + 4));
+        if (!_mm256_testc_si256(_mm256_and_si256(a, b), ones)) break;
+    }
+    return find_zero_from(words, nbits, i);
+}
+
+TARGET_AVX2 static size_t avx2_find_set(const uint64_t* words, size_t nbits) {
+    size_t full = nbits / 64;
+    size_t i = 0;
+    for (; i + 8 <= full; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(words + i + 4));
+        __m256i any = _mm256_or_si256(a, b);
+        if (!_mm256_testz_si256(any, any)) break;
+    }
+    return find_set_from(words, nbits, i);
+}
+
+// Підрахунок таблицею півбайтів через vpshufb (метод Мули)
+TARGET_AVX2 static size_t avx2_count_zero(const uint64_t* words, size_t nbits) {
+    size_t full = nbits / 64;
+    size_t i = 0;
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    for (; i + 4 <= full; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i lo = _mm256_and_si256(v, low);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    return nbits - (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) - count_set_from(words, nbits, i);
+}
+
+static bool cpu_has(BitmapIsa isa) {
+#if defined(_MSC_VER)
+    int info[4];
+    if (isa == BITMAP_ISA_SSE2) {
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+    }
+    // AVX2 потребує ще й збереження YMM-регістрів операційною системою
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0) return false;
+    if ((_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    if (isa == BITMAP_ISA_SSE2) return __builtin_cpu_supports("sse2");
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+static const BitmapKernels kernels[BITMAP_ISA_COUNT] = {
+    {scalar_find_zero, scalar_find_set, scalar_count_zero},
+#if BITMAP_X86
+    {sse2_find_zero, sse2_find_set, sse2_count_zero},
+    {avx2_find_zero, avx2_find_set, avx2_count_zero},
+#endif
+};
+
+const BitmapKernels* bitmap_kernels_for(BitmapIsa isa) {
+    if (isa == BITMAP_ISA_SCALAR) return &kernels[BITMAP_ISA_SCALAR];
+#if BITMAP_X86
+    if ((isa == BITMAP_ISA_SSE2 || isa == BITMAP_ISA_AVX2) && cpu_has(isa)) return &kernels[isa];
+#endif
+    return NULL;
+}
+
+BitmapIsa bitmap_best_isa(void) {
+    for (int isa = BITMAP_ISA_COUNT - 1; isa > BITMAP_ISA_SCALAR; isa--) {
+        if (bitmap_kernels_for((BitmapIsa)isa) != NULL) return (BitmapIsa)isa;
+    }
+    return BITMAP_ISA_SCALAR;
+}
+
+// Вибір один раз; гонка між потоками нешкідлива - усі запишуть те саме
+static const BitmapKernels* active = NULL;
+
+static const BitmapKernels* active_kernels(void) {
+    if (active == NULL) active = bitmap_kernels_for(bitmap_best_isa());
+    return active;
+}
+
+size_t bitmap_find_zero(const uint64_t* words, size_t nbits) {
+    return active_kernels()->find_zero(words, nbits);
+}
+
+size_t bitmap_find_set(const uint64_t* words, size_t nbits) {
+    return active_kernels()->find_set(words, nbits);
+}
+
+size_t bitmap_count_zero(const uint64_t* words, size_t nbits) {
+    return active_kernels()->count_zero(words, nbits);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Ядра для бітових карт зайнятості (слоти слабів, непорожні класи).
+ * Біт 1 - зайнято / непорожньо. Біти за межею nbits в останньому слові
+ * ігноруються. Реалізація (скалярна, SSE2 або AVX2) обирається під час
+ * першого виклику за CPUID.
+ */
+#define BITMAP_NONE ((size_t)-1)
+
+typedef enum BitmapIsa {
+    BITMAP_ISA_SCALAR,
+    BITMAP_ISA_SSE2,
+    BITMAP_ISA_AVX2,
+    BITMAP_ISA_COUNT
+} BitmapIsa;
+
+typedef struct BitmapKernels {
+    /* Перший нульовий біт (вільний слот) або BITMAP_NONE */
+    size_t (*find_zero)(const uint64_t* words, size_t nbits);
+    /* Перший одиничний біт (непорожній клас) або BITMAP_NONE */
+    size_t (*find_set)(const uint64_t* words, size_t nbits);
+    /* Кількість нульових бітів (вільних слотів) */
+    size_t (*count_zero)(const uint64_t* words, size_t nbits);
+} BitmapKernels;
+
+/* Ядра конкретного набору інструкцій; NULL, якщо процесор його не має */
+const BitmapKernels* bitmap_kernels_for(BitmapIsa isa);
+
+/* Найкращий набір, доступний на цьому процесорі */
+BitmapIsa bitmap_best_isa(void);
+
+/* Виклики через обрані за CPUID ядра */
+size_t bitmap_find_zero(const uint64_t* words, size_t nbits);
+size_t bitmap_find_set(const uint64_t* words, size_t nbits);
+size_t bitmap_count_zero(const uint64_t* words, size_t nbits);
+
+#endif
\ No newline at end of file
@@ -4,6 +4,15 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#ifndef MEM_HARDENED
+#define MEM_HARDENED 0
+#endif
+
+/* Максимальне вирівнювання payload */
+#ifndef MAX_ALIGN
+#define MAX_ALIGN (sizeof(long double))
+#endif
+
 /* Теги у молодших бітах */
 enum {
     BLOCK_FLAG_BUSY  = 1 << 0,
@@ -11,45 +20,138 @@ enum {
     BLOCK_FLAG_LAST  = 1 << 2
 };
 
+#define BLOCK_FLAGS_MASK ((size_t)(BLOCK_FLAG_BUSY | BLOCK_FLAG_FIRST | BLOCK_FLAG_LAST))
+
 typedef struct Block {
     /* Розмір поточного блока з тегами; включає заголовок */
     size_t size_flags;
     /* Розмір попереднього блока з тегами */
     size_t prev_size_flags;
+#if MEM_HARDENED
+    /* Контрольна сума заголовка (див. block_seal) */
+    size_t checksum;
+    /* Запитаний користувачем розмір; після нього лежить канарка */
+    size_t requested;
+#endif
     /* Далі йде payload або службові поля для вільного блока */
 } Block;
 
+/* Розмір заголовка блока - константа часу компіляції */
+#define BLOCK_HEADER_SIZE ((sizeof(Block) + MAX_ALIGN - 1) & ~(MAX_ALIGN - 1))
+
+#if MEM_HARDENED
+/* Перерахувати контрольну суму заголовка після зміни полів */
+void block_seal(Block*);
+
+/* Чи збігається контрольна сума з вмістом заголовка */
+bool block_check_seal(Block*);
+
+#define BLOCK_RESEAL(b) block_seal(b)
+#else
+#define BLOCK_RESEAL(b) ((void)0)
+#endif
+
+/*
+ * Аксесори гарячого шляху визначені тут як static inline і не
+ * перевіряють NULL: викликач гарантує, що блок існує.
+ */
+
+/* Допоміжне вирівнювання (a - степінь двійки) */
+static inline size_t align_up(size_t x, size_t a) {
+    return (x + (a - 1)) & ~(a - 1);
+}
+
 /* Розмір заголовка блока */
-size_t block_header_size(void);
+static inline size_t block_header_size(void) {
+    return BLOCK_HEADER_SIZE;
+}
 
 /* Отримати чистий розмір (без флагів) */
-size_t block_get_size(Block*);
+static inline size_t block_get_size(Block* b) {
+    return b->size_flags & ~BLOCK_FLAGS_MASK;
+}
 
 /* Встановити розмір (зберігаючи/оновлюючи флаги) */
-void block_set_size(Block*, size_t);
+static inline void block_set_size(Block* b, size_t size) {
+    b->size_flags = size | (b->size_flags & BLOCK_FLAGS_MASK);
+    BLOCK_RESEAL(b);
+}
 
 /* Розміри prev */
-size_t block_get_size_prev(Block*);
-void block_set_size_prev(Block*, size_t);
+static inline size_t block_get_size_prev(Block* b) {
+    return b->prev_size_flags & ~BLOCK_FLAGS_MASK;
+}
+
+static inline void block_set_size_prev(Block* b, size_t size) {
+    b->prev_size_flags = size | (b->prev_size_flags & BLOCK_FLAGS_MASK);
+    BLOCK_RESEAL(b);
+}
 
 /* Флаги */
-bool block_get_flag_busy(Block*);
-bool block_get_flag_first(Block*);
-bool block_get_flag_last(Block*);
+static inline bool block_get_flag_busy(Block* b) {
+    return (b->size_flags & BLOCK_FLAG_BUSY) != 0;
+}
 
-void block_set_flag_busy(Block*, bool);
-void block_set_flag_first(Block*, bool);
-void block_set_flag_last(Block*, bool);
+static inline bool block_get_flag_first(Block* b) {
+    return (b->size_flags & BLOCK_FLAG_FIRST) != 0;
+}
 
-/* Перехід до наступного/попереднього блока за офсетами */
-Block* block_next(Block* base, Block* cur, size_t arena_size);
-Block* block_prev(Block* base, Block* cur);
+static inline bool block_get_flag_last(Block* b) {
+    return (b->size_flags & BLOCK_FLAG_LAST) != 0;
+}
+
+static inline void block_set_flag(Block* b, size_t flag, bool v) {
+    if (v)
+        b->size_flags |= flag;
+    else
+        b->size_flags &= ~flag;
+    BLOCK_RESEAL(b);
+}
+
+static inline void block_set_flag_busy(Block* b, bool v) {
+    block_set_flag(b, BLOCK_FLAG_BUSY, v);
+}
+
+static inline void block_set_flag_first(Block* b, bool v) {
+    block_set_flag(b, BLOCK_FLAG_FIRST, v);
+}
+
+static inline void block_set_flag_last(Block* b, bool v) {
+    block_set_flag(b, BLOCK_FLAG_LAST, v);
+}
 
 /* Доступ до payload */
-void* block_payload(Block*);
+static inline void* block_payload(Block* b) {
+    return (void*)((unsigned char*)b + BLOCK_HEADER_SIZE);
+}
+
+/* Блок за вказівником на payload */
+static inline Block* block_from_payload(void* ptr) {
+    return (Block*)((unsigned char*)ptr - BLOCK_HEADER_SIZE);
+}
+
+/* Перехід до наступного блока з перевіркою меж арени */
+Block* block_next(Block* base, Block* cur, size_t arena_size);
+
+/* Попередній блок за prev_size; NULL для першого блока арени */
+static inline Block* block_prev(Block* base, Block* cur) {
+    (void)base; // Не використовується, але залишаємо для консистентності
+    size_t psz = block_get_size_prev(cur);
+    if (psz == 0) return NULL;
+    return (Block*)((unsigned char*)cur - psz);
+}
 
-/* Допоміжне вирівнювання */
-size_t align_up(size_t x, size_t a);
+/* Ініціалізація нового блока */
+static inline void block_initialize(Block* b, size_t size, bool busy, bool first, bool last) {
+    b->size_flags = size
+        | (busy ? BLOCK_FLAG_BUSY : 0)
+        | (first ? BLOCK_FLAG_FIRST : 0)
+        | (last ? BLOCK_FLAG_LAST : 0);
+    b->prev_size_flags = 0;
+#if MEM_HARDENED
+    b->requested = 0;
+#endif
+    BLOCK_RESEAL(b);
+}
 
 #endif
-void block_initialize(Block* b, size_t size, bool busy, bool first, bool last);
\ No newline at end of file
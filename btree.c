@@ -0,0 +1,315 @@
+#include "btree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Порядок записів: за ключем, а однакові ключі - за адресою даних */
+static bool pair_less(size_t k1, void* d1, size_t k2, void* d2) {
+    if (k1 != k2) return k1 < k2;
+    return (uintptr_t)d1 < (uintptr_t)d2;
+}
+
+/* Залишок вузлів до штучної відмови (btree_set_node_budget); -1 - без меж */
+static long node_budget = -1;
+
+void btree_set_node_budget(long budget) {
+    node_budget = budget;
+}
+
+static BTreeNode* btree_node_new(bool leaf) {
+    if (node_budget == 0) return NULL;
+    if (node_budget > 0) node_budget--;
+    BTreeNode* n = (BTreeNode*)malloc(sizeof(BTreeNode));
+    if (!n) return NULL;
+    n->count = 0;
+    n->leaf = leaf;
+    n->next = NULL;
+    return n;
+}
+
+/* Перший ключ вузла, не менший за key (порівнюються лише розміри) */
+static int size_rank(const BTreeNode* n, size_t key) {
+    int i = 0;
+    while (i < n->count && n->keys[i] < key) i++;
+    return i;
+}
+
+/* Перша пара вузла, не менша за (key, data) */
+static int pair_rank(const BTreeNode* n, size_t key, void* data) {
+    int i = 0;
+    while (i < n->count && pair_less(n->keys[i], n->data[i], key, data)) i++;
+    return i;
+}
+
+/* Дитина, в якій має лежати пара: роздільник дорівнює найменшій парі правої дитини */
+static int child_index(const BTreeNode* n, size_t key, void* data) {
+    int i = 0;
+    while (i < n->count && !pair_less(key, data, n->keys[i], n->data[i])) i++;
+    return i;
+}
+
+static void insert_entry(BTreeNode* n, int pos, size_t key, void* data) {
+    memmove(n->keys + pos + 1, n->keys + pos, (size_t)(n->count - pos) * sizeof(size_t));
+    memmove(n->data + pos + 1, n->data + pos, (size_t)(n->count - pos) * sizeof(void*));
+    n->keys[pos] = key;
+    n->data[pos] = data;
+    n->count++;
+}
+
+static void remove_entry(BTreeNode* n, int pos) {
+    memmove(n->keys + pos, n->keys + pos + 1, (size_t)(n->count - pos - 1) * sizeof(size_t));
+    memmove(n->data + pos, n->data + pos + 1, (size_t)(n->count - pos - 1) * sizeof(void*));
+    n->count--;
+}
+
+/* Розщеплення повної дитини parent->child[i]; parent має вільне місце */
+static bool split_child(BTreeNode* parent, int i) {
+    BTreeNode* left = parent->child[i];
+    BTreeNode* right = btree_node_new(left->leaf);
+    if (!right) return false;
+
+    int half = BTREE_MAX_KEYS / 2;
+    size_t up_key;
+    void* up_data;
+    if (left->leaf) {
+        // Лист ділиться навпіл, вгору йде копія першої пари правої половини
+        right->count = BTREE_MAX_KEYS - half;
+        memcpy(right->keys, left->keys + half, (size_t)right->count * sizeof(size_t));
+        memcpy(right->data, left->data + half, (size_t)right->count * sizeof(void*));
+        right->next = left->next;
+        left->next = right;
+        up_key = right->keys[0];
+        up_data = right->data[0];
+    } else {
+        // Середній роздільник переходить у батька
+        up_key = left->keys[half];
+        up_data = left->data[half];
+        right->count = BTREE_MAX_KEYS - half - 1;
+        memcpy(right->keys, left->keys + half + 1, (size_t)right->count * sizeof(size_t));
+        memcpy(right->data, left->data + half + 1, (size_t)right->count * sizeof(void*));
+        memcpy(right->child, left->child + half + 1, (size_t)(right->count + 1) * sizeof(BTreeNode*));
+    }
+    left->count = half;
+
+    memmove(parent->child + i + 2, parent->child + i + 1, (size_t)(parent->count - i) * sizeof(BTreeNode*));
+    insert_entry(parent, i, up_key, up_data);
+    parent->child[i + 1] = right;
+    return true;
+}
+
+/* Вставка з розщепленням повних вузлів на шляху вниз, за один прохід */
+bool btree_insert(BTree* tree, size_t key, void* data) {
+    if (!tree->root) {
+        tree->root = btree_node_new(true);
+        if (!tree->root) return false;
+    }
+    if (tree->root->count == BTREE_MAX_KEYS) {
+        BTreeNode* root = btree_node_new(false);
+        if (!root) return false;
+        root->child[0] = tree->root;
+        if (!split_child(root, 0)) {
+            free(root);
+            return false;
+        }
+        tree->root = root;
+    }
+
+    BTreeNode* n = tree->root;
+    while (!n->leaf) {
+        int i = child_index(n, key, data);
+        if (n->child[i]->count == BTREE_MAX_KEYS) {
+            if (!split_child(n, i)) return false;
+            if (!pair_less(key, data, n->keys[i], n->data[i])) i++;
+        }
+        n = n->child[i];
+    }
+    insert_entry(n, pair_rank(n, key, data), key, data);
+    tree->count++;
+    return true;
+}
+
+/* Перенесення крайньої пари лівого сусіда в child[i] */
+static void borrow_left(BTreeNode* parent, int i) {
+    BTreeNode* c = parent->child[i];
+    BTreeNode* l = parent->child[i - 1];
+    if (c->leaf) {
+        insert_entry(c, 0, l->keys[l->count - 1], l->data[l->count - 1]);
+        l->count--;
+        parent->keys[i - 1] = c->keys[0];
+        parent->data[i - 1] = c->data[0];
+    } else {
+        memmove(c->child + 1, c->child, (size_t)(c->count + 1) * sizeof(BTreeNode*));
+        insert_entry(c, 0, parent->keys[i - 1], parent->data[i - 1]);
+        c->child[0] = l->child[l->count];
+        parent->keys[i - 1] = l->keys[l->count - 1];
+        parent->data[i - 1] = l->data[l->count - 1];
+        l->count--;
+    }
+}
+
+/* Перенесення першої пари правого сусіда в child[i] */
+static void borrow_right(BTreeNode* parent, int i) {
+    BTreeNode* c = parent->child[i];
+    BTreeNode* r = parent->child[i + 1];
+    if (c->leaf) {
+        insert_entry(c, c->count, r->keys[0], r->data[0]);
+        remove_entry(r, 0);
+        parent->keys[i] = r->keys[0];
+        parent->data[i] = r->data[0];
+    } else {
+        insert_entry(c, c->count, parent->keys[i], parent->data[i]);
+        c->child[c->count] = r->child[0];
+        parent->keys[i] = r->keys[0];
+        parent->data[i] = r->data[0];
+        memmove(r->child, r->child + 1, (size_t)r->count * sizeof(BTreeNode*));
+        remove_entry(r, 0);
+    }
+}
+
+/* Злиття child[i + 1] у child[i] з видаленням роздільника i */
+static void merge_children(BTreeNode* parent, int i) {
+    BTreeNode* a = parent->child[i];
+    BTreeNode* b = parent->child[i + 1];
+    if (a->leaf) {
+        a->next = b->next;
+    } else {
+        insert_entry(a, a->count, parent->keys[i], parent->data[i]);
+        memcpy(a->child + a->count, b->child, (size_t)(b->count + 1) * sizeof(BTreeNode*));
+    }
+    memcpy(a->keys + a->count, b->keys, (size_t)b->count * sizeof(size_t));
+    memcpy(a->data + a->count, b->data, (size_t)b->count * sizeof(void*));
+    a->count += b->count;
+
+    remove_entry(parent, i);
+    memmove(parent->child + i + 1, parent->child + i + 2, (size_t)(parent->count - i) * sizeof(BTreeNode*));
+    free(b);
+}
+
+static void rebalance(BTreeNode* parent, int i) {
+    if (i > 0 && parent->child[i - 1]->count > BTREE_MIN_KEYS) {
+        borrow_left(parent, i);
+    } else if (i < parent->count && parent->child[i + 1]->count > BTREE_MIN_KEYS) {
+        borrow_right(parent, i);
+    } else {
+        merge_children(parent, i > 0 ? i - 1 : i);
+    }
+}
+
+static bool remove_rec(BTreeNode* n, size_t key, void* data) {
+    if (n->leaf) {
+        int pos = pair_rank(n, key, data);
+        if (pos == n->count || n->keys[pos] != key || n->data[pos] != data) return false;
+        remove_entry(n, pos);
+        return true;
+    }
+    int i = child_index(n, key, data);
+    if (!remove_rec(n->child[i], key, data)) return false;
+    if (n->child[i]->count < BTREE_MIN_KEYS) rebalance(n, i);
+    return true;
+}
+
+bool btree_remove(BTree* tree, size_t key, void* data) {
+    BTreeNode* root = tree->root;
+    if (!root || !remove_rec(root, key, data)) return false;
+    tree->count--;
+    if (root->count == 0) {
+        tree->root = root->leaf ? NULL : root->child[0];
+        free(root);
+    }
+    return true;
+}
+
+void* btree_lower_bound(const BTree* tree, size_t key, size_t* found_key) {
+    BTreeNode* n = tree->root;
+    if (!n) return NULL;
+    // Роздільник з тим самим розміром більший за (key, NULL), тож
+    // і для спуску досить порівнювати розміри
+    while (!n->leaf) n = n->child[size_rank(n, key)];
+
+    int i = size_rank(n, key);
+    if (i == n->count) {
+        n = n->next;
+        if (!n) return NULL;
+        i = 0;
+    }
+    if (found_key) *found_key = n->keys[i];
+    return n->data[i];
+}
+
+void btree_foreach(const BTree* tree, void (*fn)(size_t key, void* data, void* ctx), void* ctx) {
+    BTreeNode* n = tree->root;
+    if (!n) return;
+    while (!n->leaf) n = n->child[0];
+    for (; n; n = n->next) {
+        for (int i = 0; i < n->count; i++) fn(n->keys[i], n->data[i], ctx);
+    }
+}
+
+static void destroy_node(BTreeNode* n) {
+    if (!n->leaf) {
+        for (int i = 0; i <= n->count; i++) destroy_node(n->child[i]);
+    }
+    free(n);
+}
+
+void btree_destroy(BTree* tree) {
+    if (tree->root) destroy_node(tree->root);
+    tree->root = NULL;
+    tree->count = 0;
+}
+
+typedef struct CheckCtx {
+    int errors;
+    int leaf_depth;
+    size_t entries;
+    BTreeNode* last_leaf;
+} CheckCtx;
+
+/* Пари вузла мають лежати в [lo, hi); NULL-межа означає відсутність обмеження */
+static void check_node(CheckCtx* ctx, BTreeNode* n, BTreeNode* lo_node, int lo, BTreeNode* hi_node, int hi,
+                       int depth, bool is_root) {
+    if (n->count > BTREE_MAX_KEYS || (!is_root && n->count < BTREE_MIN_KEYS) || n->count == 0) ctx->errors++;
+    for (int i = 0; i < n->count; i++) {
+        if (i > 0 && !pair_less(n->keys[i - 1], n->data[i - 1], n->keys[i], n->data[i])) ctx->errors++;
+        if (lo_node && pair_less(n->keys[i], n->data[i], lo_node->keys[lo], lo_node->data[lo])) ctx->errors++;
+        if (hi_node && !pair_less(n->keys[i], n->data[i], hi_node->keys[hi], hi_node->data[hi])) ctx->errors++;
+    }
+
+    if (n->leaf) {
+        if (ctx->leaf_depth < 0) ctx->leaf_depth = depth;
+        if (depth != ctx->leaf_depth) ctx->errors++;
+        if (ctx->last_leaf && ctx->last_leaf->next != n) ctx->errors++;
+        ctx->last_leaf = n;
+        ctx->entries += (size_t)n->count;
+        return;
+    }
+    for (int i = 0; i <= n->count; i++) {
+        check_node(ctx, n->child[i],
+                   i > 0 ? n : lo_node, i > 0 ? i - 1 : lo,
+                   i < n->count ? n : hi_node, i < n->count ? i : hi,
+                   depth + 1, false);
+    }
+}
+
+int btree_check(const BTree* tree) {
+    if (!tree->root) return tree->count == 0 ? 0 : 1;
+    CheckCtx ctx = {0, -1, 0, NULL};
+    check_node(&ctx, tree->root, NULL, 0, NULL, 0, 0, true);
+    if (ctx.last_leaf && ctx.last_leaf->next != NULL) ctx.errors++;
+    if (ctx.entries != tree->count) ctx.errors++;
+    return ctx.errors;
+}
+
+static void show_entry(size_t key, void* data, void* ctx) {
+    (void)ctx;
+    printf("  Key: %zu, Data: %p\n", key, data);
+}
+
+void btree_show(const BTree* tree) {
+    if (!tree->root) {
+        printf("  (empty tree)\n");
+        return;
+    }
+    btree_foreach(tree, show_entry, NULL);
+}
\ No newline at end of file
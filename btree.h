@@ -0,0 +1,56 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * B+-дерево вільних блоків за парою (розмір, адреса) - альтернатива
+ * AVL з tree.c. Розміри вузла лежать суцільним масивом, тож спуск на
+ * рівень коштує один-два рядки кешу замість окремого вузла на кожне
+ * порівняння, а висота при 10^6 блоках - 5-6 рівнів замість ~25.
+ * Записи зберігаються лише в листах, листи зв'язані для обходу.
+ */
+#define BTREE_MAX_KEYS 16
+#define BTREE_MIN_KEYS (BTREE_MAX_KEYS / 2 - 1)
+
+typedef struct BTreeNode {
+    size_t keys[BTREE_MAX_KEYS];  // Розміри: пошук читає лише цей масив
+    void* data[BTREE_MAX_KEYS];   // Блоки (у внутрішніх - роздільники)
+    int count;
+    bool leaf;
+    struct BTreeNode* next;       // Наступний лист
+    struct BTreeNode* child[BTREE_MAX_KEYS + 1];  // Лише у внутрішніх вузлах
+} BTreeNode;
+
+typedef struct BTree {
+    BTreeNode* root;
+    size_t count;
+} BTree;
+
+/* Вставка пари; false, якщо не вдалося виділити вузол */
+bool btree_insert(BTree* tree, size_t key, void* data);
+
+/* Видалення саме цієї пари; false, якщо її немає */
+bool btree_remove(BTree* tree, size_t key, void* data);
+
+/* Найменший ключ >= key (серед рівних - найнижча адреса); NULL, якщо немає */
+void* btree_lower_bound(const BTree* tree, size_t key, size_t* found_key);
+
+/* Обхід пар у порядку зростання */
+void btree_foreach(const BTree* tree, void (*fn)(size_t key, void* data, void* ctx), void* ctx);
+
+/* Звільнення всіх вузлів */
+void btree_destroy(BTree* tree);
+
+/* Перевірка порядку, заповненості, глибини листів і ланцюга; кількість порушень */
+int btree_check(const BTree* tree);
+
+/* Діагностика дерева */
+void btree_show(const BTree* tree);
+
+/* Для тестів: після budget нових вузлів виділення відмовляє, як при
+ * нестачі пам'яті; від'ємне значення знімає обмеження */
+void btree_set_node_budget(long budget);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "buddy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+static size_t units_per_chunk(const Buddy* buddy) {
+    return (size_t)1 << buddy->max_order;
+}
+
+// Шматки вирівняні на свій розмір, тож початок шматка - маскою адреси
+static BuddyChunk* chunk_of(const Buddy* buddy, void* ptr) {
+    char* base = (char*)((uintptr_t)ptr & ~(uintptr_t)(buddy->chunk_size - 1));
+    for (BuddyChunk* chunk = buddy->chunks; chunk != NULL; chunk = chunk->next) {
+        if (chunk->base == base) return chunk;
+    }
+    return NULL;
+}
+
+static size_t unit_index(const Buddy* buddy, BuddyChunk* chunk, void* ptr) {
+    return (size_t)((char*)ptr - chunk->base) / buddy->unit;
+}
+
+static void push_free(Buddy* buddy, BuddyChunk* chunk, size_t index, unsigned order) {
+    BuddyFree* node = (BuddyFree*)(chunk->base + index * buddy->unit);
+    node->prev = NULL;
+    node->next = buddy->free_lists[order];
+    if (node->next != NULL) node->next->prev = node;
+    buddy->free_lists[order] = node;
+    chunk->order_of[index] = (unsigned char)order;
+}
+
+static void unlink_free(Buddy* buddy, BuddyChunk* chunk, size_t index, unsigned order) {
+    BuddyFree* node = (BuddyFree*)(chunk->base + index * buddy->unit);
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        buddy->free_lists[order] = node->next;
+    }
+    if (node->next != NULL) node->next->prev = node->prev;
+    chunk->order_of[index] = BUDDY_NOT_FREE;
+}
+
+bool buddy_init(Buddy* buddy, size_t unit, size_t chunk_size) {
+    memset(buddy, 0, sizeof(*buddy));
+    if (unit == 0 || chunk_size < unit * 4) return false;
+
+    unsigned order = 0;
+    while ((unit << order) < chunk_size) order++;
+    if (order >= BUDDY_MAX_ORDERS || (unit << order) != chunk_size) return false;
+
+    buddy->unit = unit;
+    buddy->chunk_size = chunk_size;
+    buddy->max_order = order;
+    return true;
+}
+
+int buddy_order_for(const Buddy* buddy, size_t size) {
+    if (buddy->unit == 0) return -1;
+    unsigned order = 0;
+    while (order < buddy->max_order && (buddy->unit << order) < size) order++;
+    return order < buddy->max_order ? (int)order : -1;
+}
+
+void* buddy_alloc(Buddy* buddy, unsigned order) {
+    unsigned k = order;
+    while (k <= buddy->max_order && buddy->free_lists[k] == NULL) k++;
+    if (k > buddy->max_order) return NULL;
+
+    BuddyFree* node = buddy->free_lists[k];
+    BuddyChunk* chunk = chunk_of(buddy, node);
+    size_t index = unit_index(buddy, chunk, node);
+    unlink_free(buddy, chunk, index, k);
+
+    // Зайва права половина на кожному кроці стає вільним блоком на порядок менше
+    while (k > order) {
+        k--;
+        push_free(buddy, chunk, index + ((size_t)1 << k), k);
+    }
+    chunk->free_units -= (size_t)1 << order;
+    if (chunk == buddy->spare) buddy->spare = NULL;
+    return node;
+}
+
+bool buddy_add_chunk(Buddy* buddy, void* base) {
+    size_t units = units_per_chunk(buddy);
+    BuddyChunk* chunk = (BuddyChunk*)malloc(sizeof(BuddyChunk) + units);
+    if (chunk == NULL) return false;
+
+    chunk->base = (char*)base;
+    chunk->next = buddy->chunks;
+    chunk->free_units = units;
+    memset(chunk->order_of, BUDDY_NOT_FREE, units);
+    buddy->chunks = chunk;
+    push_free(buddy, chunk, 0, buddy->max_order);
+    return true;
+}
+
+// Вилучити порожній шматок зі списків; повертає його адресу для зняття
+static void* detach_chunk(Buddy* buddy, BuddyChunk* chunk) {
+    unlink_free(buddy, chunk, 0, buddy->max_order);
+    BuddyChunk** link = &buddy->chunks;
+    while (*link != chunk) link = &(*link)->next;
+    *link = chunk->next;
+    void* base = chunk->base;
+    free(chunk);
+    return base;
+}
+
+void* buddy_free(Buddy* buddy, void* ptr, unsigned order) {
+    BuddyChunk* chunk = chunk_of(buddy, ptr);
+    if (chunk == NULL) return NULL;
+    size_t index = unit_index(buddy, chunk, ptr);
+    chunk->free_units += (size_t)1 << order;
+
+    // Напарник вільний цілком і того самого порядку - зливаємося
+    while (order < buddy->max_order) {
+        size_t mate = index ^ ((size_t)1 << order);
+        if (chunk->order_of[mate] != order) break;
+        unlink_free(buddy, chunk, mate, order);
+        index &= ~((size_t)1 << order);
+        order++;
+    }
+    push_free(buddy, chunk, index, order);
+
+    if (chunk->free_units < units_per_chunk(buddy)) return NULL;
+    if (buddy->spare == NULL) {
+        buddy->spare = chunk;
+        return NULL;
+    }
+
+    // Запасний шматок уже є: цей віддаємо на зняття
+    return detach_chunk(buddy, chunk);
+}
+
+void* buddy_trim(Buddy* buddy) {
+    BuddyChunk* spare = buddy->spare;
+    if (spare == NULL) return NULL;
+    buddy->spare = NULL;
+    return detach_chunk(buddy, spare);
+}
+
+void buddy_reset(Buddy* buddy, void (*release)(void* base, size_t size)) {
+    while (buddy->chunks != NULL) {
+        BuddyChunk* next = buddy->chunks->next;
+        if (release != NULL) release(buddy->chunks->base, buddy->chunk_size);
+        free(buddy->chunks);
+        buddy->chunks = next;
+    }
+    memset(buddy->free_lists, 0, sizeof(buddy->free_lists));
+    buddy->spare = NULL;
+}
+
+static int check_fail(const char* what, void* where) {
+    fprintf(stderr, "mem_check: buddy: %s (%p)\n", what, where);
+    return 1;
+}
+
+int buddy_check(const Buddy* buddy) {
+    int errors = 0;
+    size_t free_entries = 0;
+    size_t units = units_per_chunk(buddy);
+
+    for (BuddyChunk* chunk = buddy->chunks; chunk != NULL; chunk = chunk->next) {
+        if (((uintptr_t)chunk->base & (buddy->chunk_size - 1)) != 0) errors += check_fail("chunk is not aligned", chunk->base);
+        size_t free_units = 0;
+        for (size_t i = 0; i < units; i++) {
+            unsigned order = chunk->order_of[i];
+            if (order == BUDDY_NOT_FREE) continue;
+            void* block = chunk->base + i * buddy->unit;
+            size_t span = (size_t)1 << order;
+            if (order > buddy->max_order || (i & (span - 1)) != 0) {
+                errors += check_fail("free block is not aligned to its order", block);
+                continue;
+            }
+            for (size_t j = i + 1; j < i + span; j++) {
+                if (chunk->order_of[j] != BUDDY_NOT_FREE) errors += check_fail("free blocks overlap", block);
+            }
+            if (order < buddy->max_order && chunk->order_of[i ^ span] == order) {
+                errors += check_fail("free buddies were not merged", block);
+            }
+            free_units += span;
+            free_entries++;
+        }
+        if (free_units != chunk->free_units) errors += check_fail("free unit count is stale", chunk->base);
+    }
+    if (buddy->spare != NULL && buddy->spare->free_units != units) {
+        errors += check_fail("spare chunk is not empty", buddy->spare->base);
+    }
+
+    size_t listed = 0;
+    for (unsigned order = 0; order <= buddy->max_order && buddy->unit != 0; order++) {
+        BuddyFree* prev = NULL;
+        for (BuddyFree* node = buddy->free_lists[order]; node != NULL; node = node->next) {
+            BuddyChunk* chunk = chunk_of(buddy, node);
+            if (chunk == NULL) {
+                errors += check_fail("free list entry outside every chunk", node);
+                break;
+            }
+            if (chunk->order_of[unit_index(buddy, chunk, node)] != order) {
+                errors += check_fail("free list entry has a different order", node);
+            }
+            if (node->prev != prev) errors += check_fail("broken free list back link", node);
+            prev = node;
+            listed++;
+        }
+    }
+    if (listed != free_entries) errors += check_fail("free block is missing from the lists", NULL);
+    return errors;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Сторінковий buddy-алокатор для середніх блоків. Пам'ять приходить
+ * шматками по unit << max_order байт, вирівняними на власний розмір;
+ * блок порядку k займає unit << k байт за кратною цьому зсуву адресою,
+ * тож його напарник лежить за зсувом XOR розмір. Які одиниці шматка
+ * починають вільний блок і якого порядку, записано в метаданих поза
+ * шматком: злиття не читає пам'ять зайнятих блоків.
+ *
+ * Модуль не звертається до ОС: шматки відображає і знімає викликач.
+ * Один повністю вільний шматок лишається про запас, наступні
+ * повертаються викликачу для зняття.
+ */
+#define BUDDY_MAX_ORDERS 32
+#define BUDDY_NOT_FREE 0xFF
+
+/* Вільний блок: зв'язки списку свого порядку лежать у ньому самому */
+typedef struct BuddyFree {
+    struct BuddyFree* next;
+    struct BuddyFree* prev;
+} BuddyFree;
+
+typedef struct BuddyChunk {
+    char* base;
+    struct BuddyChunk* next;
+    size_t free_units;
+    /* Для кожної одиниці: порядок вільного блока, що з неї починається, або BUDDY_NOT_FREE */
+    unsigned char order_of[];
+} BuddyChunk;
+
+typedef struct Buddy {
+    size_t unit;
+    size_t chunk_size;
+    unsigned max_order;
+    BuddyFree* free_lists[BUDDY_MAX_ORDERS];
+    BuddyChunk* chunks;
+    BuddyChunk* spare;
+} Buddy;
+
+/* unit і chunk_size - степені двійки; шматок має вміщати хоча б чотири одиниці */
+bool buddy_init(Buddy* buddy, size_t unit, size_t chunk_size);
+
+/* Порядок найменшого блока на size байт; -1, якщо блок мав би бути більшим за пів шматка */
+int buddy_order_for(const Buddy* buddy, size_t size);
+
+/* Блок порядку order або NULL, якщо у шматках немає місця */
+void* buddy_alloc(Buddy* buddy, unsigned order);
+
+/* Віддати новий шматок (base вирівняна на chunk_size); false - не вистачило пам'яті на метадані */
+bool buddy_add_chunk(Buddy* buddy, void* base);
+
+/* Повернути блок зі злиттям; якщо спорожнів зайвий шматок - його адреса для зняття */
+void* buddy_free(Buddy* buddy, void* ptr, unsigned order);
+
+/* Віддати запасний порожній шматок на зняття; NULL, якщо його немає */
+void* buddy_trim(Buddy* buddy);
+
+/* Забути всі шматки, викликавши release для кожного */
+void buddy_reset(Buddy* buddy, void (*release)(void* base, size_t size));
+
+/* Перевірка списків і метаданих; повертає кількість порушень */
+int buddy_check(const Buddy* buddy);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "conf.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#define CONF_MAX_TOKEN 256
+
+static char trace_path[CONF_MAX_TOKEN];
+
+static const char* const policy_names[] = {"best", "first", "next", "good"};
+
+static bool is_separator(char c) {
+    return c == ',' || c == ';' || isspace((unsigned char)c);
+}
+
+static bool parse_size(const char* value, size_t* out) {
+    if (!isdigit((unsigned char)*value)) return false;
+    char* end;
+    errno = 0;
+    unsigned long long n = strtoull(value, &end, 10);
+    if (errno == ERANGE) return false;
+    unsigned shift = 0;
+    switch (tolower((unsigned char)*end)) {
+    case 'k': shift = 10; end++; break;
+    case 'm': shift = 20; end++; break;
+    case 'g': shift = 30; end++; break;
+    default: break;
+    }
+    if (*end != '\0' || n > (SIZE_MAX >> shift)) return false;
+    *out = (size_t)n << shift;
+    return true;
+}
+
+static bool parse_unsigned(const char* value, unsigned* out) {
+    size_t n;
+    if (!parse_size(value, &n) || n > 0xFFFFFFFFu) return false;
+    *out = (unsigned)n;
+    return true;
+}
+
+static bool parse_bool(const char* value, bool* out) {
+    static const char* const yes[] = {"1", "true", "yes", "on"};
+    static const char* const no[] = {"0", "false", "no", "off"};
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(value, yes[i]) == 0) {
+            *out = true;
+            return true;
+        }
+        if (strcmp(value, no[i]) == 0) {
+            *out = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Одна пара; false - невідомий ключ або погане значення
+static bool apply(const char* key, const char* value, MemConfig* config) {
+    if (strcmp(key, "page_size") == 0) return parse_size(value, &config->page_size);
+    if (strcmp(key, "arena_size") == 0) return parse_size(value, &config->arena_size);
+    if (strcmp(key, "good_fit_percent") == 0) return parse_unsigned(value, &config->good_fit_percent);
+    if (strcmp(key, "large_threshold") == 0) return parse_size(value, &config->large_threshold);
+    if (strcmp(key, "class_cache_limit") == 0) return parse_unsigned(value, &config->class_cache_limit);
+    if (strcmp(key, "size_class_max") == 0) return parse_size(value, &config->size_class_max);
+    if (strcmp(key, "purge_decay_ms") == 0) return parse_unsigned(value, &config->purge_decay_ms);
+    if (strcmp(key, "arena_colors") == 0) return parse_unsigned(value, &config->arena_colors);
+    if (strcmp(key, "huge_pages") == 0) return parse_bool(value, &config->huge_pages);
+    if (strcmp(key, "soft_limit") == 0) return parse_size(value, &config->soft_limit);
+    if (strcmp(key, "hard_limit") == 0) return parse_size(value, &config->hard_limit);
+    if (strcmp(key, "tlsf") == 0) return parse_bool(value, &config->tlsf);
+    if (strcmp(key, "tlsf_pool_size") == 0) return parse_size(value, &config->tlsf_pool_size);
+    if (strcmp(key, "tlsf_fixed") == 0) return parse_bool(value, &config->tlsf_fixed);
+    if (strcmp(key, "latency_sample") == 0) return parse_unsigned(value, &config->latency_sample);
+
+    if (strcmp(key, "policy") == 0) {
+        for (int i = 0; i < 4; i++) {
+            if (strcmp(value, policy_names[i]) == 0) {
+                config->policy = (MemPolicy)i;
+                return true;
+            }
+        }
+        return false;
+    }
+    // Кілька куп - це купи NUMA-вузлів; більше, ніж вузлів у системі, - емуляція
+    if (strcmp(key, "heaps") == 0) {
+        unsigned heaps;
+        if (!parse_unsigned(value, &heaps) || heaps == 0) return false;
+        config->numa = heaps > 1;
+        config->numa_nodes = (int)heaps;
+        return true;
+    }
+    if (strcmp(key, "trace") == 0) {
+        if (*value == '\0') return false;
+        strcpy(trace_path, value);
+        config->trace_path = trace_path;
+        return true;
+    }
+    return false;
+}
+
+bool conf_parse(const char* text, MemConfig* config) {
+    bool ok = true;
+    if (text == NULL) return true;
+
+    const char* p = text;
+    for (;;) {
+        while (is_separator(*p)) p++;
+        if (*p == '\0') break;
+
+        const char* start = p;
+        while (*p != '\0' && !is_separator(*p)) p++;
+        size_t length = (size_t)(p - start);
+
+        char token[CONF_MAX_TOKEN];
+        if (length >= sizeof(token)) {
+            fprintf(stderr, "%s: entry too long: %.32s...\n", CONF_ENV, start);
+            ok = false;
+            continue;
+        }
+        memcpy(token, start, length);
+        token[length] = '\0';
+
+        char* value = strchr(token, '=');
+        if (value == NULL) {
+            fprintf(stderr, "%s: expected key=value, got '%s'\n", CONF_ENV, token);
+            ok = false;
+            continue;
+        }
+        *value++ = '\0';
+        if (!apply(token, value, config)) {
+            fprintf(stderr, "%s: bad entry '%s=%s'\n", CONF_ENV, token, value);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void conf_print(FILE* out, const MemConfig* config) {
+    fprintf(out, "page_size=%zu\n", config->page_size);
+    fprintf(out, "arena_size=%zu\n", config->arena_size);
+    if ((unsigned)config->policy < sizeof(policy_names) / sizeof(policy_names[0])) {
+        fprintf(out, "policy=%s\n", policy_names[config->policy]);
+    } else {
+        fprintf(out, "policy=%u\n", (unsigned)config->policy);
+    }
+    fprintf(out, "good_fit_percent=%u\n", config->good_fit_percent);
+    fprintf(out, "heaps=%d\n", config->numa ? config->numa_nodes : 1);
+    fprintf(out, "large_threshold=%zu\n", config->large_threshold);
+    fprintf(out, "class_cache_limit=%u\n", config->class_cache_limit);
+    fprintf(out, "size_class_max=%zu\n", config->size_class_max);
+    fprintf(out, "purge_decay_ms=%u\n", config->purge_decay_ms);
+    fprintf(out, "arena_colors=%u\n", config->arena_colors);
+    fprintf(out, "huge_pages=%d\n", config->huge_pages ? 1 : 0);
+    fprintf(out, "soft_limit=%zu\n", config->soft_limit);
+    fprintf(out, "hard_limit=%zu\n", config->hard_limit);
+    fprintf(out, "tlsf=%d\n", config->tlsf ? 1 : 0);
+    fprintf(out, "tlsf_pool_size=%zu\n", config->tlsf_pool_size);
+    fprintf(out, "tlsf_fixed=%d\n", config->tlsf_fixed ? 1 : 0);
+    fprintf(out, "latency_sample=%u\n", config->latency_sample);
+    if (config->trace_path != NULL) fprintf(out, "trace=%s\n", config->trace_path);
+}
\ No newline at end of file
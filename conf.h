@@ -0,0 +1,30 @@
+#ifndef CONF_H
+#define CONF_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "allocator.h"
+
+/*
+ * Налаштування рядком: пари ключ=значення через кому, крапку з комою
+ * або пробіл, наприклад "arena_size=256k,policy=first,heaps=2".
+ * Розміри - байти з необов'язковим суфіксом k, m або g (степені 1024),
+ * прапорці - 1/0, true/false, yes/no, on/off. mem_init_config накладає
+ * рядок зі змінної середовища CONF_ENV поверх переданої конфігурації.
+ *
+ * Ключі: page_size, arena_size, policy (best|first|next|good),
+ * good_fit_percent, heaps, large_threshold, class_cache_limit,
+ * size_class_max, purge_decay_ms, arena_colors, huge_pages, soft_limit,
+ * hard_limit, tlsf, tlsf_pool_size, tlsf_fixed, latency_sample, trace.
+ */
+#define CONF_ENV "MEM_CONF"
+
+/* Застосувати до config усі коректні пари; про невідомі ключі й погані
+ * значення повідомляє в stderr і повертає false. Шлях trace копіюється
+ * у статичний буфер і лишається дійсним до наступного розбору */
+bool conf_parse(const char* text, MemConfig* config);
+
+/* Записати config у тому ж форматі, по парі на рядок */
+void conf_print(FILE* out, const MemConfig* config);
+
+#endif
\ No newline at end of file
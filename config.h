@@ -1,7 +0,0 @@
-#pragma once
-#include <stdio.h>
-#include <stdbool.h>
-#include <stdlib.h>
-
-#define PAGE_SIZE 4096 
-#define ARENA_PAGES 16
\ No newline at end of file
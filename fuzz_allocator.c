@@ -0,0 +1,237 @@
+// fuzz_allocator.c - fuzz-ціль для API алокатора з тіньовою моделлю
+//
+// Вхідний потік байтів перетворюється на послідовність mem_alloc(_aligned) / mem_free(_sized) / дескрипторів з mem_compact /
+// mem_realloc / mem_init (з випадковою політикою розміщення). Для кожного живого вказівника модель пам'ятає
+// розмір і байт-шаблон; після кожної операції перевіряються дані, відсутність
+// перекриттів і mem_check().
+//
+// Збірка з libFuzzer (clang): -DMEM_FUZZ_LIBFUZZER -fsanitize=fuzzer,address,undefined
+// Без libFuzzer файл має власний main: аргументи - файли зі входами,
+// або "-random N [seed]" для N випадкових входів.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "allocator.h"
+
+#define FUZZ_SLOTS 32
+#define FUZZ_MAX_SMALL 1024
+#define FUZZ_MAX_LARGE (64 * 1024)
+
+typedef struct Shadow {
+    unsigned char* ptr;
+    size_t size;
+    unsigned char pattern;
+    /* З mem_alloc_aligned: mem_free_sized для нього не можна */
+    bool aligned;
+    /* Переміщуваний об'єкт; ptr оновлюється після mem_compact */
+    MemHandle handle;
+} Shadow;
+
+static Shadow shadow[FUZZ_SLOTS];
+
+static void fuzz_fail(const char* what, int slot) {
+    fprintf(stderr, "fuzz_allocator: %s (slot %d)\n", what, slot);
+    abort();
+}
+
+static void verify_slot(int slot, size_t upto) {
+    Shadow* s = &shadow[slot];
+    for (size_t i = 0; i < upto; i++) {
+        if (s->ptr[i] != s->pattern) fuzz_fail("payload data changed", slot);
+    }
+}
+
+static void check_new_pointer(int slot) {
+    Shadow* s = &shadow[slot];
+    if ((uintptr_t)s->ptr % sizeof(void*) != 0) fuzz_fail("misaligned pointer", slot);
+
+    for (int i = 0; i < FUZZ_SLOTS; i++) {
+        Shadow* o = &shadow[i];
+        if (i == slot || o->ptr == NULL) continue;
+        if (s->ptr < o->ptr + o->size && o->ptr < s->ptr + s->size) {
+            fuzz_fail("allocation overlaps a live block", slot);
+        }
+    }
+}
+
+static void free_slot(Shadow* s) {
+    if (s->handle != NULL) {
+        mem_handle_free(s->handle);
+        s->handle = NULL;
+    } else {
+        mem_free(s->ptr);
+    }
+}
+
+static void release_all(void) {
+    for (int i = 0; i < FUZZ_SLOTS; i++) {
+        if (shadow[i].ptr != NULL) {
+            verify_slot(i, shadow[i].size);
+            free_slot(&shadow[i]);
+        }
+    }
+    memset(shadow, 0, sizeof(shadow));
+}
+
+static size_t take_size(const uint8_t** data, size_t* left) {
+    if (*left < 2) return 1;
+    size_t v = ((size_t)(*data)[0] << 8) | (*data)[1];
+    *data += 2;
+    *left -= 2;
+    // Переважно дрібні запити, зрідка - великі (окремі арени)
+    return (v & 0x8000) ? (v & 0x7fff) % FUZZ_MAX_LARGE + 1 : v % FUZZ_MAX_SMALL + 1;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    mem_init(4096, 8192);
+    memset(shadow, 0, sizeof(shadow));
+
+    while (size >= 2) {
+        uint8_t op = data[0];
+        int slot = data[1] % FUZZ_SLOTS;
+        data += 2;
+        size -= 2;
+        Shadow* s = &shadow[slot];
+
+        switch (op % 8) {
+        case 0: case 1: case 2:
+            // alloc у вільний слот або free зайнятого
+            if (s->ptr == NULL) {
+                s->size = take_size(&data, &size);
+                s->aligned = (op % 8 == 2);
+                if (s->aligned) {
+                    // Вирівняне виділення: 32 .. 2048 байт
+                    size_t alignment = (size_t)32 << ((op >> 3) % 7);
+                    s->ptr = (unsigned char*)mem_alloc_aligned(alignment, s->size);
+                    if (s->ptr == NULL) fuzz_fail("mem_alloc_aligned returned NULL", slot);
+                    if ((uintptr_t)s->ptr % alignment != 0) fuzz_fail("mem_alloc_aligned misaligned", slot);
+                } else if (op & 0x80) {
+                    s->handle = mem_handle_alloc(s->size);
+                    if (s->handle == NULL) fuzz_fail("mem_handle_alloc returned NULL", slot);
+                    s->ptr = (unsigned char*)mem_handle_lock(s->handle);
+                    mem_handle_unlock(s->handle);
+                } else {
+                    s->ptr = (unsigned char*)mem_alloc(s->size);
+                }
+                if (s->ptr == NULL) fuzz_fail("mem_alloc returned NULL", slot);
+                s->pattern = (unsigned char)(op ^ slot);
+                check_new_pointer(slot);
+                memset(s->ptr, s->pattern, s->size);
+            } else {
+                verify_slot(slot, s->size);
+                if (op % 8 == 1 && !s->aligned && s->handle == NULL) {
+                    mem_free_sized(s->ptr, s->size);
+                } else {
+                    free_slot(s);
+                }
+                s->ptr = NULL;
+                s->size = 0;
+            }
+            break;
+        case 3: case 4: case 5: {
+            if (s->handle != NULL) break;
+            size_t new_size = (op % 8 == 5) ? 0 : take_size(&data, &size);
+            size_t keep = s->size < new_size ? s->size : new_size;
+            if (s->ptr != NULL) verify_slot(slot, s->size);
+
+            unsigned char* p = (unsigned char*)mem_realloc(s->ptr, new_size);
+            if (new_size == 0) {
+                if (p != NULL) fuzz_fail("mem_realloc(ptr, 0) returned non-NULL", slot);
+                s->ptr = NULL;
+                s->size = 0;
+                s->aligned = false;
+                break;
+            }
+            if (p == NULL) fuzz_fail("mem_realloc returned NULL", slot);
+            // realloc на місці лишає блок вирівняним
+            s->aligned = s->aligned && p == s->ptr;
+            s->ptr = p;
+            s->size = new_size;
+            check_new_pointer(slot);
+            verify_slot(slot, keep);
+            memset(s->ptr + keep, s->pattern, new_size - keep);
+            break;
+        }
+        case 6:
+            if (s->ptr != NULL) {
+                s->pattern = (unsigned char)(s->pattern + 1);
+                memset(s->ptr, s->pattern, s->size);
+            }
+            break;
+        case 7:
+            // Повна переініціалізація доступна лише зрідка
+            if (slot == 0) {
+                MemConfig config = {0};
+                config.page_size = 4096;
+                config.arena_size = (size_t)(data[-1] % 4 + 1) * 8192;
+                config.policy = (MemPolicy)((data[-1] >> 2) % 4);
+                // Зрідка - рушій TLSF з малим пулом, щоб частіше додавалися нові
+                config.tlsf = ((data[-1] >> 4) & 3) == 0;
+                config.tlsf_pool_size = 128 * 1024;
+                // М'яка межа змушує очищати арени і скидати сторінки вільних блоків
+                config.soft_limit = (data[-1] & 0x40) ? 64 * 1024 : 0;
+                release_all();
+                mem_init_config(&config);
+            } else {
+                // Перенесені об'єкти мають зберегти дані
+                mem_compact((size_t)data[-1] * 256);
+                for (int i = 0; i < FUZZ_SLOTS; i++) {
+                    if (shadow[i].handle == NULL) continue;
+                    shadow[i].ptr = (unsigned char*)mem_handle_lock(shadow[i].handle);
+                    mem_handle_unlock(shadow[i].handle);
+                    verify_slot(i, shadow[i].size);
+                }
+            }
+            break;
+        }
+
+        if (mem_check() != 0) fuzz_fail("heap invariants violated", slot);
+    }
+
+    release_all();
+    if (mem_check() != 0) fuzz_fail("heap invariants violated after cleanup", -1);
+    return 0;
+}
+
+#ifndef MEM_FUZZ_LIBFUZZER
+static int run_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    static uint8_t buf[1 << 20];
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf, n);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "-random") == 0) {
+        long runs = atol(argv[2]);
+        unsigned int seed = argc >= 4 ? (unsigned int)atol(argv[3]) : 1;
+        static uint8_t buf[4096];
+
+        for (long r = 0; r < runs; r++) {
+            size_t n = 0;
+            seed = seed * 1103515245u + 12345u;
+            size_t len = 16 + (seed >> 8) % (sizeof(buf) - 16);
+            for (; n < len; n++) {
+                seed = seed * 1103515245u + 12345u;
+                buf[n] = (uint8_t)(seed >> 16);
+            }
+            LLVMFuzzerTestOneInput(buf, len);
+        }
+        printf("fuzz_allocator: %ld random inputs OK\n", runs);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (run_file(argv[i]) != 0) return 1;
+    }
+    return 0;
+}
+#endif
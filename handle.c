@@ -0,0 +1,56 @@
+#include "handle.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef struct HandleChunk {
+    MemHandleSlot slots[HANDLE_CHUNK_SLOTS];
+    struct HandleChunk* next;
+} HandleChunk;
+
+static HandleChunk* chunks = NULL;
+static MemHandleSlot* free_slots = NULL;
+
+MemHandleSlot* handle_slot_alloc(void) {
+    if (free_slots == NULL) {
+        HandleChunk* chunk = (HandleChunk*)calloc(1, sizeof(HandleChunk));
+        if (chunk == NULL) return NULL;
+        chunk->next = chunks;
+        chunks = chunk;
+        for (int i = HANDLE_CHUNK_SLOTS - 1; i >= 0; i--) {
+            chunk->slots[i].next_free = free_slots;
+            free_slots = &chunk->slots[i];
+        }
+    }
+
+    MemHandleSlot* slot = free_slots;
+    free_slots = slot->next_free;
+    slot->next_free = NULL;
+    slot->locks = 0;
+    return slot;
+}
+
+void handle_slot_free(MemHandleSlot* slot) {
+    slot->block = NULL;
+    slot->locks = 0;
+    slot->next_free = free_slots;
+    free_slots = slot;
+}
+
+bool handle_slot_valid(const MemHandleSlot* slot) {
+    for (HandleChunk* chunk = chunks; chunk != NULL; chunk = chunk->next) {
+        uintptr_t start = (uintptr_t)chunk->slots;
+        uintptr_t end = (uintptr_t)(chunk->slots + HANDLE_CHUNK_SLOTS);
+        uintptr_t p = (uintptr_t)slot;
+        if (p >= start && p < end && (p - start) % sizeof(MemHandleSlot) == 0) return true;
+    }
+    return false;
+}
+
+void handle_table_reset(void) {
+    while (chunks != NULL) {
+        HandleChunk* next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+    free_slots = NULL;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef HANDLE_H
+#define HANDLE_H
+
+#include <stdbool.h>
+
+/*
+ * Таблиця дескрипторів переміщуваних блоків. Слоти живуть у фрагментах
+ * фіксованого розміру, тож адреса слота (сам дескриптор) ніколи не змінюється.
+ * Синхронізацію забезпечує викликач.
+ */
+#define HANDLE_CHUNK_SLOTS 1024
+
+typedef struct MemHandleSlot {
+    /* Блок з даними (Block*); NULL - слот вільний */
+    void* block;
+    /* Скільки разів дескриптор заблоковано; заблокований блок не переміщується */
+    unsigned locks;
+    struct MemHandleSlot* next_free;
+} MemHandleSlot;
+
+/* Взяти вільний слот; NULL, якщо не вистачило пам'яті */
+MemHandleSlot* handle_slot_alloc(void);
+
+/* Повернути слот у вільні */
+void handle_slot_free(MemHandleSlot* slot);
+
+/* Чи вказує slot на слот таблиці (для перевірки зворотного посилання з блока) */
+bool handle_slot_valid(const MemHandleSlot* slot);
+
+/* Звільнити всю таблицю; дескриптори стають недійсними */
+void handle_table_reset(void);
+
+#endif
\ No newline at end of file
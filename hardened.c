@@ -0,0 +1,112 @@
+#include "hardened.h"
+
+#if MEM_HARDENED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if MEM_QUARANTINE_SLOTS > 0
+#define QUARANTINE_CAP MEM_QUARANTINE_SLOTS
+#else
+#define QUARANTINE_CAP 1
+#endif
+
+static Block* quarantine[QUARANTINE_CAP];
+static size_t quarantine_head = 0;
+static size_t quarantine_count = 0;
+
+void hardened_report(const char* what, void* ptr) {
+    fprintf(stderr, "mem: %s (ptr %p)\n", what, ptr);
+    fflush(stderr);
+    abort();
+}
+
+static unsigned char* payload_end(Block* b) {
+    return (unsigned char*)b + block_get_size(b);
+}
+
+void hardened_arm(Block* b, size_t requested) {
+    unsigned char* canary = (unsigned char*)block_payload(b) + requested;
+    b->requested = requested;
+    block_seal(b);
+    memset(canary, MEM_CANARY_BYTE, (size_t)(payload_end(b) - canary));
+}
+
+void hardened_check_busy(Block* b) {
+    void* ptr = block_payload(b);
+
+    if (!block_check_seal(b)) hardened_report("corrupted block header", ptr);
+    if (!block_get_flag_busy(b)) hardened_report("double free", ptr);
+
+    unsigned char* p = (unsigned char*)ptr + b->requested;
+    unsigned char* end = payload_end(b);
+    for (; p < end; p++) {
+        if (*p != MEM_CANARY_BYTE) hardened_report("buffer overflow past requested size", ptr);
+    }
+}
+
+void hardened_poison(Block* b) {
+    unsigned char* p = (unsigned char*)block_payload(b);
+    memset(p, MEM_POISON_BYTE, (size_t)(payload_end(b) - p));
+}
+
+/* Будь-який змінений байт у вільному блоці означає запис після звільнення */
+static void check_poison(Block* b) {
+    unsigned char* p = (unsigned char*)block_payload(b);
+    unsigned char* end = payload_end(b);
+
+    if (!block_check_seal(b)) hardened_report("corrupted header of freed block", p);
+    for (; p < end; p++) {
+        if (*p != MEM_POISON_BYTE) hardened_report("write after free", block_payload(b));
+    }
+}
+
+Block* hardened_quarantine_push(Block* b) {
+#if MEM_QUARANTINE_SLOTS > 0
+    Block* evicted = NULL;
+    if (quarantine_count == QUARANTINE_CAP) {
+        evicted = hardened_quarantine_pop();
+    }
+    quarantine[(quarantine_head + quarantine_count) % QUARANTINE_CAP] = b;
+    quarantine_count++;
+    return evicted;
+#else
+    check_poison(b);
+    return b;
+#endif
+}
+
+Block* hardened_quarantine_pop(void) {
+    if (quarantine_count == 0) return NULL;
+    Block* b = quarantine[quarantine_head];
+    quarantine_head = (quarantine_head + 1) % QUARANTINE_CAP;
+    quarantine_count--;
+    check_poison(b);
+    return b;
+}
+
+bool hardened_in_quarantine(Block* b) {
+    for (size_t i = 0; i < quarantine_count; i++) {
+        if (quarantine[(quarantine_head + i) % QUARANTINE_CAP] == b) return true;
+    }
+    return false;
+}
+
+void hardened_quarantine_drop(void* start, size_t size) {
+    size_t kept = 0;
+    for (size_t i = 0; i < quarantine_count; i++) {
+        Block* b = quarantine[(quarantine_head + i) % QUARANTINE_CAP];
+        if ((char*)b >= (char*)start && (char*)b < (char*)start + size) continue;
+        quarantine[(quarantine_head + kept) % QUARANTINE_CAP] = b;
+        kept++;
+    }
+    quarantine_count = kept;
+}
+
+void hardened_reset(void) {
+    quarantine_head = 0;
+    quarantine_count = 0;
+}
+
+#endif
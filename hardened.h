@@ -0,0 +1,57 @@
+#ifndef HARDENED_H
+#define HARDENED_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "block.h"
+
+/*
+ * Налагоджувальний (hardened) режим алокатора. Увімкнюється при збірці
+ * з -DMEM_HARDENED=1; у звичайній збірці цей модуль порожній і швидкий
+ * шлях mem_alloc/mem_free не змінюється.
+ */
+#if MEM_HARDENED
+
+/* Кількість байтів канарки після запитаного розміру */
+#ifndef MEM_CANARY_SIZE
+#define MEM_CANARY_SIZE 16
+#endif
+
+/* Довжина черги карантину (0 вимикає карантин) */
+#ifndef MEM_QUARANTINE_SLOTS
+#define MEM_QUARANTINE_SLOTS 64
+#endif
+
+#define MEM_CANARY_BYTE 0xCA
+#define MEM_POISON_BYTE 0xDD
+
+/* Повідомити про пошкодження купи та аварійно завершити процес */
+void hardened_report(const char* what, void* ptr);
+
+/* Запам'ятати запитаний розмір і записати канарку після нього */
+void hardened_arm(Block* b, size_t requested);
+
+/* Перевірити заголовок, прапорець зайнятості та канарку перед звільненням */
+void hardened_check_busy(Block* b);
+
+/* Заповнити payload вільного блока отрутою */
+void hardened_poison(Block* b);
+
+/* Покласти блок у карантин; повертає витіснений (найстаріший) блок або NULL */
+Block* hardened_quarantine_push(Block* b);
+
+/* Забрати з карантину наступний блок (FIFO) або NULL, якщо порожньо */
+Block* hardened_quarantine_pop(void);
+
+/* Чи лежить блок зараз у карантині */
+bool hardened_in_quarantine(Block* b);
+
+/* Викинути з карантину блоки з діапазону [start, start + size) (знищення купи) */
+void hardened_quarantine_drop(void* start, size_t size);
+
+/* Скинути карантин (mem_init) */
+void hardened_reset(void);
+
+#endif
+
+#endif
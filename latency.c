@@ -0,0 +1,240 @@
+#include "latency.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#include <intrin.h>
+#define atomic_cas_ptr(p, o, n) (InterlockedCompareExchangePointer((PVOID volatile*)(p), (n), (o)) == (o))
+#define atomic_cas_long(p, o, n) (InterlockedCompareExchange((p), (n), (o)) == (o))
+#define atomic_release_long(p) InterlockedExchange((p), 0)
+static unsigned highest_bit(uint64_t v) {
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (unsigned)index;
+}
+#else
+#define atomic_cas_ptr(p, o, n) __sync_bool_compare_and_swap((p), (o), (n))
+#define atomic_cas_long(p, o, n) __sync_bool_compare_and_swap((p), (o), (n))
+#define atomic_release_long(p) __sync_lock_release(p)
+static unsigned highest_bit(uint64_t v) {
+    return 63u - (unsigned)__builtin_clzll(v);
+}
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#if !defined(_MSC_VER)
+#include <x86intrin.h>
+#endif
+#define LATENCY_TSC 1
+#else
+#define LATENCY_TSC 0
+#endif
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+typedef struct LatencyHistogram {
+    uint64_t buckets[MEM_LAT_OP_COUNT][MEM_LAT_PATH_COUNT][LATENCY_BUCKETS];
+    uint64_t max[MEM_LAT_OP_COUNT][MEM_LAT_PATH_COUNT];
+    volatile long owned;  /* 1 - пише живий потік; 0 - вільна для наступного */
+    struct LatencyHistogram* next;
+} LatencyHistogram;
+
+volatile unsigned latency_sample_rate = 0;
+LATENCY_THREAD_LOCAL unsigned char latency_path = LATENCY_NO_PATH;
+LATENCY_THREAD_LOCAL uint64_t latency_start = 0;
+LATENCY_THREAD_LOCAL unsigned latency_counter = 0;
+
+static LatencyHistogram* volatile latency_list = NULL;
+static LATENCY_THREAD_LOCAL LatencyHistogram* local_histogram = NULL;
+/* Скільки наносекунд в одному такті лічильника */
+static double ns_per_tick = 1.0;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+#ifdef _WIN32
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t latency_now(void) {
+#if LATENCY_TSC
+    return __rdtsc();
+#else
+    return monotonic_ns();
+#endif
+}
+
+// Частота TSC оцінюється один раз за ~2 мс при ввімкненні
+static void calibrate(void) {
+#if LATENCY_TSC
+    uint64_t ns0 = monotonic_ns();
+    uint64_t tsc0 = __rdtsc();
+    uint64_t ns1;
+    do {
+        ns1 = monotonic_ns();
+    } while (ns1 - ns0 < 2000000);
+    uint64_t tsc1 = __rdtsc();
+    if (tsc1 > tsc0) ns_per_tick = (double)(ns1 - ns0) / (double)(tsc1 - tsc0);
+#endif
+}
+
+static unsigned bucket_of(uint64_t v) {
+    if (v < LATENCY_SUB_BUCKETS) return (unsigned)v;
+    unsigned e = highest_bit(v);
+    if (e > LATENCY_MAX_EXP) return LATENCY_BUCKETS - 1;
+    unsigned mant = (unsigned)(v >> (e - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+    return (e - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS + mant;
+}
+
+// Найбільше значення, що потрапляє в кошик
+static uint64_t bucket_upper(unsigned b) {
+    if (b < LATENCY_SUB_BUCKETS) return b;
+    unsigned e = b / LATENCY_SUB_BUCKETS + LATENCY_SUB_BITS - 1;
+    uint64_t mant = b % LATENCY_SUB_BUCKETS;
+    uint64_t low = (LATENCY_SUB_BUCKETS + mant) << (e - LATENCY_SUB_BITS);
+    return low + ((uint64_t)1 << (e - LATENCY_SUB_BITS)) - 1;
+}
+
+// Після виходу потоку гістограма лишається в списку (її дані ще входять у
+// mem_latency_stats), але звільняється для наступного нового потоку, тож
+// список не довший за найбільшу кількість одночасних потоків
+static void latency_retire(void* histogram) {
+    local_histogram = NULL;
+    if (histogram != NULL) atomic_release_long(&((LatencyHistogram*)histogram)->owned);
+}
+
+#if defined(_WIN32)
+static DWORD exit_key = FLS_OUT_OF_INDEXES;
+static INIT_ONCE exit_key_once = INIT_ONCE_STATIC_INIT;
+
+static VOID WINAPI retire_callback(PVOID histogram) {
+    latency_retire(histogram);
+}
+
+static BOOL CALLBACK make_exit_key(PINIT_ONCE once, PVOID param, PVOID* context) {
+    (void)once;
+    (void)param;
+    (void)context;
+    exit_key = FlsAlloc(retire_callback);
+    return TRUE;
+}
+
+static void retire_at_exit(LatencyHistogram* h) {
+    InitOnceExecuteOnce(&exit_key_once, make_exit_key, NULL, NULL);
+    if (exit_key != FLS_OUT_OF_INDEXES) FlsSetValue(exit_key, h);
+}
+#else
+static pthread_key_t exit_key;
+static pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+static bool exit_key_ok = false;
+
+static void make_exit_key(void) {
+    exit_key_ok = pthread_key_create(&exit_key, latency_retire) == 0;
+}
+
+static void retire_at_exit(LatencyHistogram* h) {
+    pthread_once(&exit_key_once, make_exit_key);
+    if (exit_key_ok) pthread_setspecific(exit_key, h);
+}
+#endif
+
+static LatencyHistogram* latency_local(void) {
+    if (local_histogram != NULL) return local_histogram;
+
+    // Спершу - гістограма потоку, що вже завершився
+    LatencyHistogram* h = NULL;
+    for (LatencyHistogram* it = latency_list; it != NULL; it = it->next) {
+        if (it->owned == 0 && atomic_cas_long(&it->owned, 0, 1)) {
+            h = it;
+            break;
+        }
+    }
+    if (h == NULL) {
+        h = (LatencyHistogram*)calloc(1, sizeof(LatencyHistogram));
+        if (h == NULL) return NULL;
+        h->owned = 1;
+
+        LatencyHistogram* head;
+        do {
+            head = latency_list;
+            h->next = head;
+        } while (!atomic_cas_ptr(&latency_list, head, h));
+    }
+
+    local_histogram = h;
+    retire_at_exit(h);
+    return h;
+}
+
+void latency_record(MemLatencyOp op, uint64_t start) {
+    uint64_t elapsed = latency_now() - start;
+    unsigned path = latency_path;
+    if (path == LATENCY_NO_PATH) return;
+    LatencyHistogram* h = latency_local();
+    if (h == NULL) return;
+
+    h->buckets[op][path][bucket_of(elapsed)]++;
+    if (elapsed > h->max[op][path]) h->max[op][path] = elapsed;
+}
+
+void mem_latency_enable(unsigned sample_every) {
+    if (sample_every != 0 && latency_sample_rate == 0) calibrate();
+    latency_sample_rate = sample_every;
+}
+
+void mem_latency_reset(void) {
+    // Паралельні записи під час скидання можуть загубитися - це лише статистика
+    for (LatencyHistogram* h = latency_list; h != NULL; h = h->next) {
+        memset(h->buckets, 0, sizeof(h->buckets));
+        memset(h->max, 0, sizeof(h->max));
+    }
+}
+
+static double percentile(const uint64_t* merged, uint64_t count, double q) {
+    uint64_t rank = (uint64_t)((double)count * q);
+    if (rank >= count) rank = count - 1;
+
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += merged[b];
+        if (seen > rank) return (double)bucket_upper(b) * ns_per_tick;
+    }
+    return 0.0;
+}
+
+void mem_latency_stats(MemLatencyStats* stats) {
+    if (stats == NULL) return;
+    memset(stats, 0, sizeof(*stats));
+
+    uint64_t merged[LATENCY_BUCKETS];
+    for (int op = 0; op < MEM_LAT_OP_COUNT; op++) {
+        for (int path = 0; path < MEM_LAT_PATH_COUNT; path++) {
+            uint64_t count = 0;
+            uint64_t max = 0;
+            memset(merged, 0, sizeof(merged));
+
+            for (LatencyHistogram* h = latency_list; h != NULL; h = h->next) {
+                for (unsigned b = 0; b < LATENCY_BUCKETS; b++) {
+                    merged[b] += h->buckets[op][path][b];
+                    count += h->buckets[op][path][b];
+                }
+                if (h->max[op][path] > max) max = h->max[op][path];
+            }
+
+            MemLatencySummary* s = &stats->summary[op][path];
+            s->count = (size_t)count;
+            if (count == 0) continue;
+            s->p50_ns = percentile(merged, count, 0.50);
+            s->p99_ns = percentile(merged, count, 0.99);
+            s->p999_ns = percentile(merged, count, 0.999);
+            s->max_ns = (double)max * ns_per_tick;
+        }
+    }
+}
\ No newline at end of file
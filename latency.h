@@ -0,0 +1,67 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "allocator.h"
+
+/*
+ * Гістограми затримок у стилі HDR: кожен степінь двійки ділиться на
+ * LATENCY_SUB_BUCKETS рівних частин, тож похибка значення не більша 12.5%.
+ * Кожен потік пише лише у власні гістограми, без атомарних операцій;
+ * mem_latency_stats підсумовує їх на льоту. Гістограми завершеного
+ * потоку зберігають його дані і переходять до наступного нового потоку.
+ *
+ * Швидкі операції вимірюються вибірково (одна з latency_sample_rate),
+ * бо пара читань лічильника коштує більше за саму операцію. Повільні
+ * шляхи (mmap/munmap арени) вимірюються завжди: LATENCY_SLOW на їх
+ * початку запускає відлік, якщо операцію не вибрано.
+ */
+#define LATENCY_SUB_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_EXP 47
+#define LATENCY_BUCKETS ((LATENCY_MAX_EXP - LATENCY_SUB_BITS + 2) * LATENCY_SUB_BUCKETS)
+
+#if defined(_MSC_VER)
+#define LATENCY_THREAD_LOCAL __declspec(thread)
+#else
+#define LATENCY_THREAD_LOCAL __thread
+#endif
+
+/* 0 - вимкнено, N - вимірюється кожна N-та швидка операція потоку */
+extern volatile unsigned latency_sample_rate;
+
+/* Шлях, яким пішла поточна операція (MemLatencyPath); виставляє алокатор.
+ * LATENCY_NO_PATH - операція завершилася раніше (розмір 0, завеликий
+ * запит, відмова межі) і не записується */
+#define LATENCY_NO_PATH MEM_LAT_PATH_COUNT
+extern LATENCY_THREAD_LOCAL unsigned char latency_path;
+
+/* Початок поточної операції; 0 - операція не вимірюється */
+extern LATENCY_THREAD_LOCAL uint64_t latency_start;
+extern LATENCY_THREAD_LOCAL unsigned latency_counter;
+
+/* Поточне значення лічильника (такти TSC або наносекунди) */
+uint64_t latency_now(void);
+
+/* Записати операцію, що почалася в момент start, за шляхом latency_path */
+void latency_record(MemLatencyOp op, uint64_t start);
+
+#define LATENCY_BEGIN() do { \
+        latency_start = 0; \
+        latency_path = LATENCY_NO_PATH; \
+        if (latency_sample_rate != 0 && ++latency_counter >= latency_sample_rate) { \
+            latency_counter = 0; \
+            latency_start = latency_now(); \
+        } \
+    } while (0)
+
+#define LATENCY_SLOW() do { \
+        if (latency_sample_rate != 0 && latency_start == 0) latency_start = latency_now(); \
+    } while (0)
+
+#define LATENCY_END(op) do { \
+        if (latency_start != 0) latency_record((op), latency_start); \
+    } while (0)
+
+#endif
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include <assert.h>
 #include <stdlib.h>
 #include "allocator.h"
+#include "trace.h"
+#include "bitmap.h"
+#include "btree.h"
+#include "page.h"
 
 void test_basic_functionality() {
     printf("=== TEST 1: BASIC FUNCTIONALITY ===\n");
@@ -173,6 +177,1092 @@ void test_realloc_scenarios() {
     printf("=== TEST 4 PASSED ===\n\n");
 }
 
+void test_heap_consistency() {
+    printf("=== TEST 5: HEAP CONSISTENCY UNDER RANDOM LOAD ===\n");
+
+    mem_init(4096, 8192);
+    assert(mem_check() == 0);
+
+    void* slots[64] = {0};
+    size_t sizes[64] = {0};
+    unsigned int seed = 2024;
+
+    for (int i = 0; i < 20000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int slot = (int)((seed >> 8) % 64);
+
+        if (slots[slot] != NULL) {
+            // Перевіряємо, що дані блока ніхто не зіпсував
+            unsigned char* p = (unsigned char*)slots[slot];
+            for (size_t j = 0; j < sizes[slot]; j++) {
+                assert(p[j] == (unsigned char)slot);
+            }
+            mem_free(slots[slot]);
+            slots[slot] = NULL;
+        } else {
+            sizes[slot] = 1 + (seed >> 16) % ((seed & 1) ? 200 : 9000);
+            slots[slot] = mem_alloc(sizes[slot]);
+            assert(slots[slot] != NULL);
+            memset(slots[slot], slot, sizes[slot]);
+        }
+        assert(mem_check() == 0);
+    }
+
+    for (int i = 0; i < 64; i++) {
+        mem_free(slots[i]);
+    }
+    assert(mem_check() == 0);
+    printf("✓ 20000 random operations, heap invariants hold after each\n");
+    printf("=== TEST 5 PASSED ===\n\n");
+}
+
+void test_equal_size_blocks() {
+    printf("=== TEST 6: MANY FREE BLOCKS OF EQUAL SIZE ===\n");
+
+    mem_init(4096, 64 * 1024);
+
+    void* blocks[400];
+    for (int i = 0; i < 400; i++) {
+        blocks[i] = mem_alloc(48);
+        assert(blocks[i] != NULL);
+    }
+
+    // Звільняємо кожен другий, щоб сусіди не зливалися
+    for (int i = 0; i < 400; i += 2) {
+        mem_free(blocks[i]);
+    }
+    assert(mem_check() == 0);
+    printf("✓ 200 free blocks of the same size indexed\n");
+
+    // Повторне виділення має видати 200 різних блоків
+    for (int i = 0; i < 400; i += 2) {
+        blocks[i] = mem_alloc(48);
+        assert(blocks[i] != NULL);
+        for (int j = 1; j < 400; j += 2) {
+            assert(blocks[i] != blocks[j]);
+        }
+        for (int j = 0; j < i; j += 2) {
+            assert(blocks[i] != blocks[j]);
+        }
+    }
+    assert(mem_check() == 0);
+    printf("✓ Every reused block handed out exactly once\n");
+
+    for (int i = 0; i < 400; i++) {
+        mem_free(blocks[i]);
+    }
+    assert(mem_check() == 0);
+    printf("=== TEST 6 PASSED ===\n\n");
+}
+
+void test_trace_recording() {
+    printf("=== TEST 7: ALLOCATION TRACE RECORDING ===\n");
+
+    mem_init(4096, 8192);
+    bool started = mem_trace_start("allocator_test_trace.bin");
+    assert(started);
+
+    void* a = mem_alloc(64);
+    void* b = mem_alloc(128);
+    a = mem_realloc(a, 4000);
+    mem_free(b);
+    mem_free(a);
+    mem_trace_stop();
+
+    // Заголовок і рівно п'ять записів
+    FILE* f = fopen("allocator_test_trace.bin", "rb");
+    assert(f != NULL);
+    TraceHeader header;
+    TraceRecord records[8];
+    size_t got = fread(&header, sizeof(header), 1, f);
+    assert(got == 1);
+    assert(header.magic == TRACE_MAGIC && header.record_size == sizeof(TraceRecord));
+    got = fread(records, sizeof(TraceRecord), 8, f);
+    assert(got == 5);
+    fclose(f);
+    remove("allocator_test_trace.bin");
+
+    assert(records[0].op == TRACE_OP_ALLOC && records[0].size == 64);
+    assert(records[2].op == TRACE_OP_REALLOC && records[2].old_ptr == records[0].ptr);
+    assert(records[3].op == TRACE_OP_FREE && records[3].ptr == records[1].ptr);
+    assert(records[4].ptr == records[2].ptr);
+    printf("✓ Five operations recorded with matching pointers\n");
+    printf("=== TEST 7 PASSED ===\n\n");
+}
+
+void test_numa_heaps() {
+    printf("=== TEST 8: PER-NODE HEAPS (EMULATED NUMA) ===\n");
+
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.arena_size = 64 * 1024;
+    config.policy = MEM_POLICY_BEST_FIT;
+    config.numa = true;
+    config.numa_nodes = 2;
+    mem_init_config(&config);
+    assert(mem_numa_node_count() == 2);
+
+    void* blocks[100];
+    for (int i = 0; i < 100; i++) {
+        blocks[i] = mem_alloc(16 + (i % 7) * 40);
+        assert(blocks[i] != NULL);
+    }
+    void* large = mem_alloc(256 * 1024);
+    assert(large != NULL);
+    assert(mem_check() == 0);
+
+    // Лічильники вузлів у сумі дають загальну картину
+    MemStats total;
+    mem_stats(&total);
+    size_t allocs = 0, arenas = 0, mapped = 0;
+    for (int node = 0; node < mem_numa_node_count(); node++) {
+        MemNodeStats ns;
+        mem_node_stats(node, &ns);
+        assert(ns.node == node);
+        allocs += ns.alloc_count;
+        arenas += ns.arena_count;
+        mapped += ns.mapped_bytes;
+    }
+    assert(allocs == 101);
+    assert(arenas == total.arena_count);
+    assert(mapped == total.mapped_bytes);
+    printf("✓ Node counters add up: %lu arenas, %lu bytes mapped\n",
+           (unsigned long)arenas, (unsigned long)mapped);
+
+    for (int i = 0; i < 100; i++) {
+        mem_free(blocks[i]);
+    }
+    mem_free(large);
+    assert(mem_check() == 0);
+
+    size_t frees = 0;
+    for (int node = 0; node < mem_numa_node_count(); node++) {
+        MemNodeStats ns;
+        mem_node_stats(node, &ns);
+        frees += ns.free_count;
+    }
+    assert(frees == 101);
+    printf("✓ Every block returned to the heap that allocated it\n");
+
+    mem_init(4096, 64 * 1024);
+    assert(mem_numa_node_count() == 1);
+    printf("=== TEST 8 PASSED ===\n\n");
+}
+
+void test_sized_free() {
+    printf("=== TEST 9: SIZED FREE AND ALIGNED ALLOCATION ===\n");
+
+    mem_init(4096, 64 * 1024);
+
+    void* blocks[64];
+    for (int i = 0; i < 64; i++) {
+        blocks[i] = mem_alloc((size_t)(i * 13 + 1));
+        assert(blocks[i] != NULL);
+        memset(blocks[i], i, (size_t)(i * 13 + 1));
+    }
+    for (int i = 0; i < 64; i += 2) {
+        mem_free_sized(blocks[i], (size_t)(i * 13 + 1));
+    }
+    assert(mem_check() == 0);
+
+    // Після realloc на менший розмір звільняється з новим розміром
+    blocks[1] = mem_realloc(blocks[1], 4);
+    mem_free_sized(blocks[1], 4);
+
+    // Блоки з кешу не перекривають живі
+    for (int i = 0; i < 64; i += 2) {
+        blocks[i] = mem_alloc((size_t)(i * 13 + 1));
+        assert(blocks[i] != NULL);
+        memset(blocks[i], 0xEE, (size_t)(i * 13 + 1));
+    }
+    for (int i = 3; i < 64; i += 2) {
+        unsigned char* p = (unsigned char*)blocks[i];
+        for (int j = 0; j < i * 13 + 1; j++) assert(p[j] == (unsigned char)i);
+    }
+    for (int i = 0; i < 64; i++) {
+        if (i != 1) mem_free_sized(blocks[i], (size_t)(i * 13 + 1));
+    }
+    assert(mem_check() == 0);
+    printf("✓ Sized free reuses blocks without corrupting live data\n");
+
+    void* aligned[8];
+    for (int i = 0; i < 8; i++) {
+        size_t alignment = (size_t)64 << i;
+        aligned[i] = mem_alloc_aligned(alignment, 100 + (size_t)i * 1000);
+        assert(aligned[i] != NULL);
+        assert(((size_t)aligned[i] & (alignment - 1)) == 0);
+    }
+    void* big = mem_alloc_aligned(4096, 200 * 1024);
+    assert(big != NULL && ((size_t)big & 4095) == 0);
+    assert(mem_check() == 0);
+    for (int i = 0; i < 8; i++) mem_free(aligned[i]);
+    mem_free(big);
+    assert(mem_check() == 0);
+    printf("✓ Aligned blocks from 64 to 8192 bytes\n");
+    printf("=== TEST 9 PASSED ===\n\n");
+}
+
+void test_usable_size() {
+    printf("=== TEST 10: USABLE SIZE AND SIZE ROUNDING ===\n");
+
+    mem_init(4096, 64 * 1024);
+
+    for (size_t n = 1; n <= 3000; n += 7) {
+        size_t good = mem_good_size(n);
+        assert(good >= n);
+        assert(mem_good_size(good) == good);
+
+        char* p = (char*)mem_alloc(n);
+        assert(p != NULL);
+        size_t usable = mem_usable_size(p);
+        assert(usable >= n);
+
+        // Ріст у межах доступного місця не переносить блок
+        char* q = (char*)mem_realloc(p, usable);
+        assert(q == p);
+        memset(q, 0x5A, usable);
+        mem_free_sized(q, usable);
+
+        // Звільнення з округленим розміром приймає і hardened-збірка
+        p = (char*)mem_alloc(n);
+        assert(p != NULL);
+        mem_free_sized(p, good);
+    }
+    assert(mem_check() == 0);
+    printf("✓ Rounded sizes are stable and growth within usable size stays in place\n");
+    printf("=== TEST 10 PASSED ===\n\n");
+}
+
+void test_latency_histograms() {
+    printf("=== TEST 11: LATENCY HISTOGRAMS BY PATH ===\n");
+
+    mem_init(4096, 64 * 1024);
+    mem_latency_enable(1);
+    mem_latency_reset();
+
+    void* small[32];
+    for (int i = 0; i < 32; i++) small[i] = mem_alloc(100);
+    small[0] = mem_realloc(small[0], 50);
+    void* large = mem_alloc(16 * 1024 * 1024);
+    for (int i = 0; i < 32; i += 2) mem_free(small[i]);
+    for (int i = 0; i < 32; i += 2) small[i] = mem_alloc(100);
+    mem_free(large);
+    // Операції без шляху (відмова до вибору шляху) не записуються
+    void* zero = mem_alloc(0);
+    void* huge = mem_alloc((size_t)-1);
+    assert(zero == NULL && huge == NULL);
+    mem_free(NULL);
+
+    MemLatencyStats stats;
+    mem_latency_stats(&stats);
+    assert(stats.summary[MEM_LAT_ALLOC][MEM_LAT_ARENA].count >= 1);
+    assert(stats.summary[MEM_LAT_ALLOC][MEM_LAT_LARGE].count == 1);
+    assert(stats.summary[MEM_LAT_FREE][MEM_LAT_LARGE].count == 1);
+    assert(stats.summary[MEM_LAT_REALLOC][MEM_LAT_FAST].count == 1);
+    size_t allocs = 0;
+    for (int path = 0; path < MEM_LAT_PATH_COUNT; path++) {
+        MemLatencySummary* s = &stats.summary[MEM_LAT_ALLOC][path];
+        allocs += s->count;
+        if (s->count == 0) continue;
+        assert(s->p50_ns <= s->p99_ns && s->p99_ns <= s->p999_ns);
+        assert(s->max_ns > 0);
+    }
+    assert(allocs == 32 + 1 + 16);
+    printf("✓ Every operation attributed to its path\n");
+
+    // При вибірці mmap/munmap все одно вимірюються всі
+    mem_latency_enable(1000);
+    mem_latency_reset();
+    for (int i = 0; i < 10; i++) mem_free(mem_alloc(16 * 1024 * 1024));
+    mem_latency_stats(&stats);
+    assert(stats.summary[MEM_LAT_ALLOC][MEM_LAT_LARGE].count == 10);
+    assert(stats.summary[MEM_LAT_FREE][MEM_LAT_LARGE].count == 10);
+    printf("✓ Slow paths are timed even when fast paths are sampled\n");
+
+    mem_latency_enable(0);
+    for (int i = 0; i < 32; i++) mem_free(small[i]);
+    assert(mem_check() == 0);
+    printf("=== TEST 11 PASSED ===\n\n");
+}
+
+void test_handle_compaction() {
+    printf("=== TEST 12: HANDLES AND COMPACTION ===\n");
+
+    mem_init(4096, 64 * 1024);
+
+    MemHandle handles[1200];
+    for (int i = 0; i < 1200; i++) {
+        handles[i] = mem_handle_alloc(200);
+        assert(handles[i] != NULL);
+        memset(mem_handle_lock(handles[i]), i & 0xFF, 200);
+        mem_handle_unlock(handles[i]);
+    }
+
+    // Лишаємо кожен десятий: усі арени стають розрідженими
+    for (int i = 0; i < 1200; i++) {
+        if (i % 10 != 0) {
+            mem_handle_free(handles[i]);
+            handles[i] = NULL;
+        }
+    }
+    // Один заблокований дескриптор тримає свою арену
+    char* pinned = (char*)mem_handle_lock(handles[0]);
+
+    MemStats before, after;
+    mem_stats(&before);
+    size_t moved = mem_compact((size_t)-1);
+    mem_stats(&after);
+    assert(mem_check() == 0);
+    assert(moved > 0);
+    assert(after.arena_count < before.arena_count);
+    printf("✓ Compaction moved %lu bytes, arenas %lu -> %lu\n",
+           (unsigned long)moved, (unsigned long)before.arena_count, (unsigned long)after.arena_count);
+
+    char* relocked = (char*)mem_handle_lock(handles[0]);
+    assert(relocked == pinned);
+    mem_handle_unlock(handles[0]);
+    mem_handle_unlock(handles[0]);
+    for (int i = 0; i < 1200; i += 10) {
+        unsigned char* p = (unsigned char*)mem_handle_lock(handles[i]);
+        for (int j = 0; j < 200; j++) assert(p[j] == (unsigned char)(i & 0xFF));
+        mem_handle_unlock(handles[i]);
+    }
+    printf("✓ Moved objects keep their data, locked ones stay in place\n");
+
+    // Нульовий бюджет нічого не переносить
+    size_t none = mem_compact(0);
+    assert(none == 0);
+    for (int i = 0; i < 1200; i += 10) mem_handle_free(handles[i]);
+    assert(mem_check() == 0);
+    printf("=== TEST 12 PASSED ===\n\n");
+}
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+
+typedef struct SharedNode {
+    size_t next;  /* зсув наступного вузла, не вказівник */
+    int value;
+} SharedNode;
+
+void test_shared_heap() {
+    printf("=== TEST 13: FILE-BACKED SHARED HEAP ===\n");
+
+    const char* path = "lab1_shared_heap.bin";
+    remove(path);
+
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.arena_size = 64 * 1024;
+    config.shared = true;
+    config.shared_path = path;
+    config.shared_size = 1024 * 1024;
+    bool opened = mem_init_config(&config);
+    assert(opened);
+
+    // Список зі зв'язками-зсувами, корінь запам'ятовується в заголовку
+    size_t head = 0;
+    for (int i = 0; i < 1000; i++) {
+        SharedNode* node = (SharedNode*)mem_alloc(sizeof(SharedNode) + (size_t)(i % 50));
+        assert(node != NULL);
+        node->value = i;
+        node->next = head;
+        head = mem_shared_offset(node);
+    }
+    size_t* root = (size_t*)mem_alloc(sizeof(size_t));
+    *root = head;
+    mem_shared_set_root(root);
+
+    // Звільняємо кожен третій, щоб у файлі лишилися вільні блоки
+    size_t* link = root;
+    for (int i = 0; *link != 0; i++) {
+        SharedNode* node = (SharedNode*)mem_shared_ptr(*link);
+        if (i % 3 == 0) {
+            *link = node->next;
+            mem_free(node);
+        } else {
+            link = &node->next;
+        }
+    }
+    assert(mem_check() == 0);
+    MemStats before;
+    mem_stats(&before);
+    printf("✓ Heap built in the mapping: %lu arenas\n", (unsigned long)before.arena_count);
+
+    // "Перезапуск": відображення знімається і відкривається знову
+    mem_init(4096, 64 * 1024);
+    config.shared_size = 0;
+    opened = mem_init_config(&config);
+    assert(opened);
+    assert(mem_check() == 0);
+    MemStats after;
+    mem_stats(&after);
+    assert(after.arena_count == before.arena_count && after.free_blocks == before.free_blocks);
+
+    root = (size_t*)mem_shared_root();
+    assert(root != NULL);
+    int count = 0;
+    int expected = 999;
+    for (size_t o = *root; o != 0; ) {
+        SharedNode* node = (SharedNode*)mem_shared_ptr(o);
+        if (expected % 3 == 0) expected--;
+        assert(node->value == expected);
+        expected--;
+        count++;
+        o = node->next;
+    }
+    assert(count == 666);
+    printf("✓ Reopened heap keeps the list and its free blocks\n");
+
+    // Нові виділення беруть вільні блоки, що пережили перевідображення
+    void* reuse = mem_alloc(16);
+    assert(reuse != NULL);
+    mem_free(reuse);
+    assert(mem_check() == 0);
+
+    mem_init(4096, 64 * 1024);
+    remove(path);
+
+    // Інший процес відкриває файл з більшим розміром і нарізає арени за межею
+    // нашого відображення; ми дорощуємо відображення, а не виходимо за нього
+    config.shared_size = 256 * 1024;
+    opened = mem_init_config(&config);
+    assert(opened);
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        config.shared_size = 4 * 1024 * 1024;
+        void* blocks[40];
+        bool ok = mem_init_config(&config);
+        for (int i = 0; ok && i < 40; i++) ok = (blocks[i] = mem_alloc(60 * 1024)) != NULL;
+        for (int i = 0; ok && i < 40; i += 2) mem_free(blocks[i]);
+        _exit(ok && mem_check() == 0 ? 0 : 1);
+    }
+    int status;
+    pid_t waited = waitpid(child, &status, 0);
+    assert(waited == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    for (int i = 0; i < 30; i++) {
+        void* p = mem_alloc(40 * 1024);
+        assert(p != NULL);
+        memset(p, 0x5A, 40 * 1024);
+    }
+    assert(mem_check() == 0);
+    printf("✓ Heap grown by another process is mapped before use\n");
+
+    mem_init(4096, 64 * 1024);
+    remove(path);
+    printf("=== TEST 13 PASSED ===\n\n");
+}
+#endif
+
+void test_bitmap_kernels() {
+    printf("=== TEST 14: SIMD BITMAP KERNELS ===\n");
+    static const char* names[BITMAP_ISA_COUNT] = {"scalar", "sse2", "avx2"};
+    const BitmapKernels* scalar = bitmap_kernels_for(BITMAP_ISA_SCALAR);
+    uint64_t words[20];
+    unsigned state = 4242;
+
+    // Невирівняні nbits перевіряють хвіст; біти за межею навмисно ненульові
+    for (int round = 0; round < 2000; round++) {
+        size_t nbits = 1 + (size_t)(round * 7) % (sizeof(words) * 8);
+        // 0 - вільний лише останній, 1 - порожньо, 2/3 - один вільний / один зайнятий, 4 - випадково
+        unsigned density = (unsigned)round % 5;
+        for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+            state = state * 1103515245u + 12345u;
+            uint64_t w = ((uint64_t)state << 32) ^ (state >> 3);
+            if (density == 0 || density == 2) w = ~(uint64_t)0;
+            if (density == 1 || density == 3) w = 0;
+            words[i] = w;
+        }
+        size_t bit = density == 0 ? nbits - 1 : (state >> 4) % nbits;
+        if (density == 0 || density == 2) words[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+        if (density == 3) words[bit / 64] |= (uint64_t)1 << (bit % 64);
+
+        size_t zero = scalar->find_zero(words, nbits);
+        size_t set = scalar->find_set(words, nbits);
+        size_t count = scalar->count_zero(words, nbits);
+        assert(zero == BITMAP_NONE || (zero < nbits && !(words[zero / 64] >> (zero % 64) & 1)));
+        assert(set == BITMAP_NONE || (set < nbits && (words[set / 64] >> (set % 64) & 1)));
+        assert(count <= nbits);
+        if (density == 0 || density == 2) assert(zero == bit && count == 1);
+        if (density == 1) assert(set == BITMAP_NONE && count == nbits);
+        if (density == 3) assert(set == bit && count == nbits - 1);
+
+        for (int isa = BITMAP_ISA_SSE2; isa < BITMAP_ISA_COUNT; isa++) {
+            const BitmapKernels* k = bitmap_kernels_for((BitmapIsa)isa);
+            if (k == NULL) continue;
+            assert(k->find_zero(words, nbits) == zero);
+            assert(k->find_set(words, nbits) == set);
+            assert(k->count_zero(words, nbits) == count);
+        }
+        assert(bitmap_find_zero(words, nbits) == zero);
+    }
+
+    for (int isa = 0; isa < BITMAP_ISA_COUNT; isa++) {
+        printf("%-6s %s\n", names[isa], bitmap_kernels_for((BitmapIsa)isa) ? "checked" : "unavailable");
+    }
+    printf("=== TEST 14 PASSED ===\n\n");
+}
+
+void test_btree_index() {
+    printf("=== TEST 15: B+ TREE FREE INDEX ===\n");
+    enum { N = 3000 };
+    static size_t keys[N];
+    static bool present[N];
+    BTree tree = {NULL, 0};
+    unsigned state = 31337;
+
+    // Багато однакових розмірів, щоб перевірити порядок за адресою
+    for (int i = 0; i < N; i++) {
+        state = state * 1103515245u + 12345u;
+        keys[i] = 16 * (1 + (state >> 8) % 64);
+        bool inserted = btree_insert(&tree, keys[i], &keys[i]);
+        assert(inserted);
+        present[i] = true;
+    }
+    assert(btree_check(&tree) == 0 && tree.count == N);
+
+    for (int round = 0; round < 20000; round++) {
+        state = state * 1103515245u + 12345u;
+        int i = (int)((state >> 8) % N);
+        if (present[i]) {
+            bool removed = btree_remove(&tree, keys[i], &keys[i]);
+            bool again = btree_remove(&tree, keys[i], &keys[i]);
+            assert(removed && !again);
+        } else {
+            bool inserted = btree_insert(&tree, keys[i], &keys[i]);
+            assert(inserted);
+        }
+        present[i] = !present[i];
+
+        // Нижня межа - найменший розмір, а серед рівних - найнижча адреса
+        size_t want = 16 * (1 + (state >> 20) % 66);
+        size_t* best = NULL;
+        for (int j = 0; j < N; j++) {
+            if (!present[j] || keys[j] < want) continue;
+            if (best == NULL || keys[j] < *best || (keys[j] == *best && &keys[j] < best)) best = &keys[j];
+        }
+        size_t found_key = 0;
+        assert(btree_lower_bound(&tree, want, &found_key) == best);
+        if (best != NULL) assert(found_key == *best);
+    }
+    assert(btree_check(&tree) == 0);
+
+    btree_destroy(&tree);
+    assert(tree.root == NULL && btree_lower_bound(&tree, 1, NULL) == NULL);
+
+    // Вузол не виділився: вставка відмовляє, а дерево лишається цілим
+    for (int i = 0; i < BTREE_MAX_KEYS; i++) {
+        bool inserted = btree_insert(&tree, keys[i], &keys[i]);
+        assert(inserted);
+    }
+    btree_set_node_budget(0);
+    bool refused = !btree_insert(&tree, keys[N - 1], &keys[N - 1]);
+    btree_set_node_budget(-1);
+    assert(refused && tree.count == BTREE_MAX_KEYS && btree_check(&tree) == 0);
+    btree_destroy(&tree);
+
+#if MEM_FREE_INDEX_BTREE
+    // Купа без нових вузлів: звільнені блоки лишаються доступними для виділення
+    mem_init(4096, 64 * 1024);
+    static void* blocks[600];
+    for (int i = 0; i < 600; i++) {
+        blocks[i] = mem_alloc(2000);
+        assert(blocks[i] != NULL);
+    }
+    MemStats before;
+    mem_stats(&before);
+    btree_set_node_budget(0);
+    for (int i = 0; i < 600; i += 2) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+    for (int i = 0; i < 600; i += 2) {
+        blocks[i] = mem_alloc(2000);
+        assert(blocks[i] != NULL);
+    }
+    MemStats after;
+    mem_stats(&after);
+    assert(after.arena_count == before.arena_count);
+    btree_set_node_budget(-1);
+    for (int i = 0; i < 600; i++) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+    mem_init(4096, 64 * 1024);
+    printf("✓ Blocks refused a tree node stay allocatable\n");
+#endif
+    printf("=== TEST 15 PASSED ===\n\n");
+}
+
+void test_heap_instances() {
+    printf("=== TEST 16: INDEPENDENT HEAP INSTANCES ===\n");
+    mem_init(4096, 64 * 1024);
+    MemStats before;
+    mem_stats(&before);
+
+    mem_heap_t* a = mem_heap_create();
+    mem_heap_t* b = mem_heap_create();
+    assert(a != NULL && b != NULL && a != b);
+
+    enum { N = 2000 };
+    static void* pa[N];
+    static void* pb[N];
+    for (int i = 0; i < N; i++) {
+        pa[i] = mem_heap_alloc(a, 16 + (size_t)(i * 13) % 700);
+        pb[i] = mem_heap_alloc(b, 16 + (size_t)(i * 29) % 3000);
+        assert(pa[i] != NULL && pb[i] != NULL);
+        memset(pa[i], 0xA1, 16);
+        memset(pb[i], 0xB2, 16);
+    }
+    // Великий блок у власному відображенні теж належить купі
+    void* big = mem_heap_alloc(a, 256 * 1024);
+    assert(big != NULL);
+
+    // Виділення з куп не чіпають основну купу
+    MemStats after;
+    mem_stats(&after);
+    assert(after.arena_count == before.arena_count);
+
+    for (int i = 0; i < N; i += 2) mem_heap_free(a, pa[i]);
+    for (int i = 1; i < N; i += 2) {
+        pa[i] = mem_heap_realloc(a, pa[i], 900);
+        assert(pa[i] != NULL && ((unsigned char*)pa[i])[15] == 0xA1);
+    }
+    assert(mem_check() == 0);
+
+    // Знищення з живими блоками: без обходу і без слідів у mem_check
+    mem_heap_destroy(a);
+    assert(mem_check() == 0);
+    for (int i = 0; i < N; i++) assert(((unsigned char*)pb[i])[0] == 0xB2);
+
+    void* p = mem_heap_realloc(b, NULL, 100);
+    assert(p != NULL);
+    mem_heap_free(b, p);
+    // mem_free_sized повертає блок його купі, а не в кеш основної
+    p = mem_heap_alloc(b, 32);
+    mem_free_sized(p, 32);
+    mem_heap_destroy(b);
+    p = mem_alloc(32);
+    memset(p, 0, 32);
+    mem_free(p);
+
+    // mem_init прибирає і ще не знищені купи
+    mem_heap_t* c = mem_heap_create();
+    void* orphan = mem_heap_alloc(c, 64);
+    assert(orphan != NULL);
+    mem_init(4096, 64 * 1024);
+    assert(mem_check() == 0);
+    printf("=== TEST 16 PASSED ===\n\n");
+}
+
+void test_tlsf_engine() {
+    printf("=== TEST 17: TLSF ENGINE ===\n");
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.tlsf = true;
+    config.tlsf_pool_size = 1024 * 1024;
+    bool ready = mem_init_config(&config);
+    assert(ready);
+
+    enum { N = 500 };
+    static void* ptrs[N];
+    static size_t sizes[N];
+    unsigned state = 555;
+    for (int round = 0; round < 20000; round++) {
+        state = state * 1103515245u + 12345u;
+        int i = (int)((state >> 8) % N);
+        size_t size = 1 + (state >> 12) % ((state & 1) ? 200 : 9000);
+        if (ptrs[i] == NULL) {
+            ptrs[i] = mem_alloc(size);
+            assert(ptrs[i] != NULL);
+            memset(ptrs[i], i & 0xFF, size);
+            sizes[i] = size;
+        } else if (state & 2) {
+            // realloc зберігає дані, зокрема при зростанні на місці
+            size_t keep = sizes[i] < size ? sizes[i] : size;
+            unsigned char* p = (unsigned char*)mem_realloc(ptrs[i], size);
+            assert(p != NULL);
+            for (size_t k = 0; k < keep; k++) assert(p[k] == (unsigned char)(i & 0xFF));
+            memset(p, i & 0xFF, size);
+            ptrs[i] = p;
+            sizes[i] = size;
+        } else {
+            mem_free(ptrs[i]);
+            ptrs[i] = NULL;
+        }
+    }
+    void* aligned = mem_alloc_aligned(4096, 100);
+    assert(aligned != NULL && ((uintptr_t)aligned & 4095) == 0);
+    assert(mem_check() == 0);
+    mem_free(aligned);
+    for (int i = 0; i < N; i++) {
+        mem_free(ptrs[i]);
+        ptrs[i] = NULL;
+    }
+
+    // Після звільнення всього пули знову злиті в один вільний блок на пул
+    MemStats stats;
+    mem_stats(&stats);
+    assert(mem_check() == 0 && stats.free_blocks == stats.arena_count);
+
+    // Фіксований пул: понад нього - NULL, а не новий пул
+    config.tlsf_fixed = true;
+    config.tlsf_pool_size = 256 * 1024;
+    ready = mem_init_config(&config);
+    assert(ready);
+    void* over = mem_alloc(512 * 1024);
+    assert(over == NULL);
+    void* most = mem_alloc(200 * 1024);
+    assert(most != NULL);
+    over = mem_alloc(100 * 1024);
+    assert(over == NULL);
+    mem_stats(&stats);
+    assert(stats.arena_count == 1);
+    mem_free(most);
+    assert(mem_check() == 0);
+
+    mem_init(4096, 64 * 1024);
+    printf("=== TEST 17 PASSED ===\n\n");
+}
+
+void test_buddy_arenas() {
+    printf("=== TEST 18: BUDDY ARENAS FOR MID-SIZE BLOCKS ===\n");
+    mem_init(4096, 64 * 1024);
+
+    // Перше виділення відображає шматок, решта вирізаються з нього
+    void* blocks[8];
+    for (int i = 0; i < 8; i++) {
+        blocks[i] = mem_alloc(100 * 1024 + (size_t)i * 8 * 1024);
+        assert(blocks[i] != NULL);
+        memset(blocks[i], i, 100 * 1024);
+    }
+    MemNodeStats node;
+    mem_node_stats(0, &node);
+    assert(node.buddy_chunks == 1);
+    assert(node.mmaps_avoided == 7);
+    assert(mem_check() == 0);
+    printf("✓ 8 blocks of ~100 KiB cost one mapping\n");
+
+    // Звільнені блоки зливаються і знову видаються без mmap
+    for (int i = 0; i < 8; i += 2) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+    for (int i = 0; i < 8; i += 2) blocks[i] = mem_alloc(200 * 1024);
+    blocks[1] = mem_realloc(blocks[1], 120 * 1024);
+    assert(((unsigned char*)blocks[1])[100 * 1024 - 1] == 1);
+    MemStats stats;
+    mem_stats(&stats);
+    mem_node_stats(0, &node);
+    assert(node.buddy_chunks == 1);
+    assert(stats.mmaps_avoided == 11);
+    printf("✓ Freed blocks are reused, realloc grows into the buddy slack\n");
+
+    // Блоки більші за пів шматка, як і раніше, отримують окреме відображення
+    void* huge = mem_alloc(6 * 1024 * 1024);
+    assert(huge != NULL);
+    mem_node_stats(0, &node);
+    assert(node.mmaps_avoided == 11);
+    mem_free(huge);
+
+    for (int i = 0; i < 8; i++) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+    mem_stats(&stats);
+    assert(stats.arena_count == 0);
+    printf("=== TEST 18 PASSED ===\n\n");
+}
+
+void test_reserve_warmup() {
+    printf("=== TEST 19: HEAP RESERVE AND PREFAULT ===\n");
+    mem_init(4096, 64 * 1024);
+    bool reserved = mem_reserve(512 * 1024, MEM_RESERVE_POPULATE);
+    assert(reserved);
+    MemStats before;
+    mem_stats(&before);
+    assert(before.arena_count == 9);
+    assert(before.free_blocks == 9);
+    assert(mem_check() == 0);
+    printf("✓ 512 KiB reserved as %zu free arenas\n", before.arena_count);
+
+    // Перші запити в межах резерву не відображають нових арен
+    mem_latency_enable(1);
+    mem_latency_reset();
+    void* blocks[1000];
+    for (int i = 0; i < 1000; i++) {
+        blocks[i] = mem_alloc(16 + (size_t)(i * 37) % 400);
+        assert(blocks[i] != NULL);
+    }
+    MemLatencyStats latency;
+    mem_latency_stats(&latency);
+    mem_latency_enable(0);
+    assert(latency.summary[MEM_LAT_ALLOC][MEM_LAT_ARENA].count == 0);
+    MemStats after;
+    mem_stats(&after);
+    assert(after.arena_count == before.arena_count);
+    printf("✓ First 1000 allocations stay inside the reserve\n");
+
+    for (int i = 0; i < 1000; i++) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+
+    // Перетин м'якої межі посеред резерву не знімає вже зарезервованих арен
+    mem_init(4096, 64 * 1024);
+    mem_set_limits(256 * 1024, 0);
+    reserved = mem_reserve(1024 * 1024, 0);
+    assert(reserved);
+    mem_stats(&after);
+    assert(after.arena_count == 17 && after.free_blocks == 17);
+    mem_set_limits(0, 0);
+    assert(mem_check() == 0);
+    printf("✓ Reserve past the soft limit keeps all %zu arenas\n", after.arena_count);
+    printf("=== TEST 19 PASSED ===\n\n");
+}
+
+static int pressure_calls = 0;
+static mem_heap_t* pressure_heap = NULL;
+
+static void on_pressure(mem_heap_t* heap, size_t mapped, void* ctx) {
+    (void)ctx;
+    assert(mapped > 0);
+    pressure_calls++;
+    pressure_heap = heap;
+}
+
+void test_memory_limits() {
+    printf("=== TEST 20: SOFT AND HARD MEMORY LIMITS ===\n");
+    mem_init(4096, 64 * 1024);
+    mem_set_pressure_callback(on_pressure, NULL);
+    mem_set_limits(256 * 1024, 0);
+
+    // Чотири арени по блоку, дві з них спорожніють
+    void* blocks[4];
+    for (int i = 0; i < 4; i++) blocks[i] = mem_alloc(60 * 1024);
+    mem_free(blocks[0]);
+    mem_free(blocks[1]);
+    assert(pressure_calls == 0);
+
+    // Шматок buddy переводить за м'яку межу: порожні арени знімаються
+    void* large = mem_alloc(200 * 1024);
+    assert(large != NULL);
+    assert(pressure_calls == 1 && pressure_heap == NULL);
+    // У hardened-збірці звільнені блоки ще в карантині, і арени не порожні
+    MemStats stats;
+    mem_stats(&stats);
+    assert(stats.arena_count == 3 || stats.arena_count == 5);
+    MemNodeStats node;
+    mem_node_stats(0, &node);
+    assert(node.purges == 1);
+    assert(mem_check() == 0);
+    printf("✓ Crossing the soft limit purged empty arenas and ran the callback\n");
+
+    // Жорстка межа окремої купи: NULL без нових відображень
+    mem_heap_t* heap = mem_heap_create();
+    mem_heap_set_limits(heap, 0, 128 * 1024);
+    void* small[256];
+    int count = 0;
+    while (count < 256 && (small[count] = mem_heap_alloc(heap, 1000)) != NULL) count++;
+    assert(count > 64 && count < 256);
+    void* refused = mem_heap_alloc(heap, 1000);
+    assert(refused == NULL);
+    mem_heap_set_limits(heap, 0, 0);
+    void* extra = mem_heap_alloc(heap, 1000);
+    assert(extra != NULL);
+    mem_heap_free(heap, extra);
+    for (int i = 0; i < count; i++) mem_heap_free(heap, small[i]);
+    mem_heap_destroy(heap);
+    printf("✓ Heap stops at its hard limit until the limit is lifted\n");
+
+    mem_set_limits(0, 0);
+    mem_set_pressure_callback(NULL, NULL);
+    mem_free(large);
+    mem_free(blocks[2]);
+    mem_free(blocks[3]);
+    assert(mem_check() == 0);
+    printf("=== TEST 20 PASSED ===\n\n");
+}
+
+void test_lifetime_hints() {
+    printf("=== TEST 21: LIFETIME HINTS ===\n");
+    mem_init(4096, 64 * 1024);
+
+    // Короткоживучі і довгоживучі блоки не ділять арен
+    void* short_lived[64];
+    void* long_lived[8];
+    for (int i = 0; i < 64; i++) short_lived[i] = mem_alloc_hint(500, MEM_HINT_SHORT);
+    for (int i = 0; i < 8; i++) long_lived[i] = mem_alloc_hint(100, MEM_HINT_LONG);
+    MemStats short_stats, long_stats;
+    mem_lifetime_stats(MEM_HINT_SHORT, &short_stats);
+    mem_lifetime_stats(MEM_HINT_LONG, &long_stats);
+    assert(short_stats.arena_count == 1 && long_stats.arena_count == 1);
+    long_lived[0] = mem_realloc(long_lived[0], 5000);
+    mem_lifetime_stats(MEM_HINT_LONG, &long_stats);
+    assert(long_stats.mapped_bytes - long_stats.free_bytes >= 5000);
+    assert(mem_check() == 0);
+    printf("✓ Short- and long-lived blocks live in separate arenas\n");
+
+    // Без довгоживучих сусідів арена коротких спорожніє і знімається
+    // (у hardened-збірці звільнені блоки ще в карантині, і арена лишається)
+    for (int i = 0; i < 64; i++) mem_free(short_lived[i]);
+    size_t released = mem_purge();
+    mem_lifetime_stats(MEM_HINT_SHORT, &short_stats);
+    assert(released > 0 ? short_stats.arena_count == 0 : short_stats.arena_count == 1);
+    for (int i = 0; i < 8; i++) mem_free(long_lived[i]);
+    assert(mem_check() == 0);
+
+    // Блок пулу, звільнений з розміром, не потрапляє в кеш основної купи
+    uintptr_t arena_mask = ~(uintptr_t)(64 * 1024 - 1);
+    void* hinted = mem_alloc_hint(100, MEM_HINT_SHORT);
+    mem_free_sized(hinted, 100);
+    void* plain = mem_alloc(100);
+    assert(((uintptr_t)plain & arena_mask) != ((uintptr_t)hinted & arena_mask));
+    mem_free(plain);
+    assert(mem_check() == 0);
+    printf("✓ mem_free_sized keeps pool blocks in their pool\n");
+    printf("=== TEST 21 PASSED ===\n\n");
+}
+
+void test_config_string() {
+    printf("=== TEST 22: CONFIGURATION STRING ===\n");
+    MemConfig config = {0};
+    bool parsed = mem_config_parse("arena_size=128k, policy=first; class_cache_limit=8 large_threshold=1m", &config);
+    assert(parsed);
+    assert(config.arena_size == 128 * 1024 && config.policy == MEM_POLICY_FIRST_FIT);
+    assert(config.class_cache_limit == 8 && config.large_threshold == 1024 * 1024);
+    bool bad_suffix = mem_config_parse("arena_size=12q", &config);
+    bool bad_key = mem_config_parse("no_such_key=1", &config);
+    assert(!bad_suffix && !bad_key);
+    assert(config.arena_size == 128 * 1024);
+    printf("✓ Config string parsed, bad entries rejected\n");
+
+    // Поріг 1 МіБ: 900 КіБ ще з buddy, 1.5 МіБ - окреме відображення
+    bool ready = mem_init_config(&config);
+    assert(ready);
+    mem_config_show();
+    void* mid = mem_alloc(900 * 1024);
+    void* big = mem_alloc(1536 * 1024);
+    MemNodeStats node;
+    mem_node_stats(0, &node);
+    assert(node.buddy_chunks == 1);
+    mem_free(mid);
+    mem_free(big);
+    assert(mem_check() == 0);
+
+    // Невідома політика стає best-fit, а не індексом за межею таблиці назв
+    MemConfig bad = {0};
+    bad.policy = (MemPolicy)42;
+    ready = mem_init_config(&bad);
+    assert(ready);
+    mem_config_show();
+    mem_free(mem_alloc(100));
+    assert(mem_check() == 0);
+
+    // Межа класів зменшується до класу 256: блок під 250 байтів уже не стає класом 320
+    size_t small = mem_good_size(100);
+    size_t rounded = mem_good_size(250);
+    MemConfig tuned = {0};
+    parsed = mem_config_parse("size_class_max=300 purge_decay_ms=1", &tuned);
+    assert(parsed && tuned.size_class_max == 300 && tuned.purge_decay_ms == 1);
+    ready = mem_init_config(&tuned);
+    assert(ready);
+    mem_config_show();
+    assert(mem_good_size(100) == small && mem_good_size(250) < rounded);
+    void* sized = mem_alloc(250);
+    mem_free_sized(sized, mem_good_size(250));
+    assert(mem_check() == 0);
+
+    // Звільнення через мілісекунду після першого очищає купу само
+    void* spread[8];
+    for (int i = 0; i < 8; i++) spread[i] = mem_alloc(10 * 1024);
+    for (int i = 0; i < 8; i++) mem_free(spread[i]);
+    usleep(2000);
+    mem_free(mem_alloc(10 * 1024));
+    MemNodeStats decayed;
+    mem_node_stats(0, &decayed);
+    assert(decayed.purges == 1);
+    assert(mem_check() == 0);
+    printf("✓ size_class_max and purge_decay_ms take effect\n");
+    mem_init(4096, 64 * 1024);
+    printf("=== TEST 22 PASSED ===\n\n");
+}
+
+void test_page_provider() {
+    printf("=== TEST 23: PAGE PROVIDER ===\n");
+    PageCounting counting;
+    page_counting_init(&counting, &page_mmap, 0);
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.arena_size = 64 * 1024;
+    config.page_provider = &counting.provider;
+    bool ready = mem_init_config(&config);
+    assert(ready);
+
+    // Кожна нова арена - рівно один reserve; mem_init повертає всі через release
+    void* blocks[8];
+    for (int i = 0; i < 8; i++) {
+        blocks[i] = mem_alloc(40 * 1024);
+        assert(blocks[i] != NULL);
+        memset(blocks[i], i, 40 * 1024);
+    }
+    assert(counting.calls[PAGE_OP_RESERVE] >= 8);
+    for (int i = 0; i < 8; i++) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+    mem_init(4096, 64 * 1024);
+    assert(counting.calls[PAGE_OP_RELEASE] == counting.calls[PAGE_OP_RESERVE]);
+    printf("✓ %zu reserves, %zu releases through the counting provider\n",
+           counting.calls[PAGE_OP_RESERVE], counting.calls[PAGE_OP_RELEASE]);
+
+    // Купа в наперед виділеному буфері: вичерпання дає NULL, а не звернення до ОС
+    static char buffer[1024 * 1024];
+    PageStatic st;
+    bool carved = page_static_init(&st, buffer, sizeof(buffer));
+    assert(carved);
+    config.page_provider = &st.provider;
+    ready = mem_init_config(&config);
+    assert(ready);
+    size_t count = 0;
+    void* p;
+    while ((p = mem_alloc(32 * 1024)) != NULL) {
+        assert((char*)p >= buffer && (char*)p < buffer + sizeof(buffer));
+        count++;
+    }
+    assert(count > 8);
+    assert(mem_check() == 0);
+    printf("✓ %zu blocks carved from a 1 MiB static buffer\n", count);
+    mem_init(4096, 64 * 1024);
+    printf("=== TEST 23 PASSED ===\n\n");
+}
+
+void test_arena_coloring() {
+    printf("=== TEST 24: ARENA CACHE COLORING ===\n");
+    // Кожен блок не вміщається в попередню арену, тож лежить першим у новій
+    MemConfig config = {0};
+    config.page_size = 4096;
+    config.arena_size = 64 * 1024;
+    bool ready = mem_init_config(&config);
+    assert(ready);
+    void* blocks[8];
+    size_t offsets[8];
+    for (int i = 0; i < 8; i++) {
+        blocks[i] = mem_alloc(40 * 1024);
+        assert(blocks[i] != NULL);
+        offsets[i] = (uintptr_t)blocks[i] & (64 * 1024 - 1);
+        for (int j = 0; j < i; j++) assert(offsets[j] != offsets[i]);
+        assert((offsets[i] - offsets[0]) % 64 == 0);
+    }
+    assert(mem_check() == 0);
+    for (int i = 0; i < 8; i++) mem_free(blocks[i]);
+    printf("✓ First blocks of 8 arenas start at 8 different cache lines\n");
+
+    bool parsed = mem_config_parse("arena_colors=1", &config);
+    assert(parsed);
+    ready = mem_init_config(&config);
+    assert(ready);
+    for (int i = 0; i < 8; i++) {
+        blocks[i] = mem_alloc(40 * 1024);
+        assert(((uintptr_t)blocks[i] & (64 * 1024 - 1)) == offsets[0]);
+    }
+    for (int i = 0; i < 8; i++) mem_free(blocks[i]);
+    assert(mem_check() == 0);
+    printf("✓ arena_colors=1 keeps every first block at the same offset\n");
+    mem_init(4096, 64 * 1024);
+    printf("=== TEST 24 PASSED ===\n\n");
+}
+
 void comprehensive_demo() {
     printf("=== COMPREHENSIVE DEMONSTRATION ===\n\n");
     
@@ -256,6 +1346,28 @@ int main() {
     test_edge_cases();
     test_fragmentation();
     test_realloc_scenarios();
+    test_heap_consistency();
+    test_equal_size_blocks();
+    test_trace_recording();
+    test_numa_heaps();
+    test_sized_free();
+    test_usable_size();
+    test_latency_histograms();
+    test_handle_compaction();
+#ifndef _WIN32
+    test_shared_heap();
+#endif
+    test_bitmap_kernels();
+    test_btree_index();
+    test_heap_instances();
+    test_tlsf_engine();
+    test_buddy_arenas();
+    test_reserve_warmup();
+    test_memory_limits();
+    test_lifetime_hints();
+    test_config_string();
+    test_page_provider();
+    test_arena_coloring();
     
     // Комплексна демонстрація
     comprehensive_demo();
@@ -0,0 +1,338 @@
+// mem_replay.c - відтворення траси виділень (mem_trace_start) на алокаторі
+//
+// Використання: mem_replay [-a mem|glibc] [-p best|first|next|good] [-s arena_size] trace.bin
+// Записи впорядковуються за часом і виконуються в одному потоці; звіт містить
+// час, приріст пікового RSS під час відтворення, кількість арен і фрагментацію.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "allocator.h"
+#include "trace.h"
+
+typedef struct Replayed {
+    uint64_t key;   // вказівник з траси; 0 - порожня комірка
+    void* ptr;      // відповідний вказівник під час відтворення
+    size_t size;
+} Replayed;
+
+// Відкрита адресація з лінійним пробуванням і зсувом при видаленні
+static Replayed* table = NULL;
+static size_t table_cap = 0;
+static size_t table_count = 0;
+
+static size_t slot_of(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (size_t)key & (table_cap - 1);
+}
+
+static void table_put(uint64_t key, void* ptr, size_t size);
+
+static void table_grow(void) {
+    Replayed* old = table;
+    size_t old_cap = table_cap;
+    table_cap = table_cap ? table_cap * 2 : 1024;
+    table = (Replayed*)calloc(table_cap, sizeof(Replayed));
+    if (table == NULL) {
+        fprintf(stderr, "mem_replay: out of memory for %zu live pointers\n", table_count);
+        exit(1);
+    }
+    table_count = 0;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].key != 0) table_put(old[i].key, old[i].ptr, old[i].size);
+    }
+    free(old);
+}
+
+static void table_put(uint64_t key, void* ptr, size_t size) {
+    if ((table_count + 1) * 2 > table_cap) table_grow();
+    size_t i = slot_of(key);
+    while (table[i].key != 0 && table[i].key != key) i = (i + 1) & (table_cap - 1);
+    if (table[i].key == 0) table_count++;
+    table[i].key = key;
+    table[i].ptr = ptr;
+    table[i].size = size;
+}
+
+static Replayed* table_get(uint64_t key) {
+    if (table_cap == 0 || key == 0) return NULL;
+    size_t i = slot_of(key);
+    while (table[i].key != 0) {
+        if (table[i].key == key) return &table[i];
+        i = (i + 1) & (table_cap - 1);
+    }
+    return NULL;
+}
+
+static void table_del(Replayed* e) {
+    size_t i = (size_t)(e - table);
+    table[i].key = 0;
+    table_count--;
+    // Зсуваємо наступні елементи ланцюжка, щоб пошук не обірвався
+    for (size_t j = (i + 1) & (table_cap - 1); table[j].key != 0; j = (j + 1) & (table_cap - 1)) {
+        Replayed moved = table[j];
+        table[j].key = 0;
+        table_count--;
+        table_put(moved.key, moved.ptr, moved.size);
+    }
+}
+
+typedef struct Allocator {
+    const char* name;
+    void* (*alloc)(size_t);
+    void (*free)(void*);
+    void* (*realloc)(void*, size_t);
+} Allocator;
+
+typedef struct Ordered {
+    TraceRecord record;
+    size_t index;  // позиція у файлі
+} Ordered;
+
+static int compare_records(const void* a, const void* b) {
+    const Ordered* x = (const Ordered*)a;
+    const Ordered* y = (const Ordered*)b;
+    if (x->record.timestamp_ns != y->record.timestamp_ns) {
+        return x->record.timestamp_ns < y->record.timestamp_ns ? -1 : 1;
+    }
+    // Записи з однаковим часом зберігають порядок у файлі
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static TraceRecord* load_trace(const char* path, size_t* count) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    TraceHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != TRACE_MAGIC ||
+        header.version != TRACE_VERSION || header.record_size != sizeof(TraceRecord)) {
+        fprintf(stderr, "%s: not a trace file of version %d\n", path, TRACE_VERSION);
+        fclose(f);
+        return NULL;
+    }
+
+    size_t cap = 1 << 16;
+    size_t n = 0;
+    TraceRecord* records = (TraceRecord*)malloc(cap * sizeof(TraceRecord));
+    for (;;) {
+        if (records == NULL) {
+            fprintf(stderr, "%s: out of memory after %zu records\n", path, n);
+            fclose(f);
+            return NULL;
+        }
+        if (n == cap) {
+            // Старий буфер лишається дійсним, якщо realloc не вдався
+            TraceRecord* grown = (TraceRecord*)realloc(records, cap * 2 * sizeof(TraceRecord));
+            if (grown == NULL) free(records);
+            records = grown;
+            cap *= 2;
+            continue;
+        }
+        size_t got = fread(records + n, sizeof(TraceRecord), cap - n, f);
+        n += got;
+        if (got == 0) break;
+    }
+    fclose(f);
+
+    // Буфери потоків скидаються в довільному порядку, тож сортуємо за часом
+    Ordered* ordered = (Ordered*)malloc((n ? n : 1) * sizeof(Ordered));
+    if (ordered == NULL) {
+        fprintf(stderr, "%s: out of memory sorting %zu records\n", path, n);
+        free(records);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++) {
+        ordered[i].record = records[i];
+        ordered[i].index = i;
+    }
+    qsort(ordered, n, sizeof(Ordered), compare_records);
+    for (size_t i = 0; i < n; i++) {
+        records[i] = ordered[i].record;
+    }
+    free(ordered);
+
+    *count = n;
+    return records;
+}
+
+// Поточне RSS у КіБ; -1, якщо /proc недоступний
+static long rss_kib(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return -1;
+    long size, resident;
+    int ok = fscanf(f, "%ld %ld", &size, &resident) == 2;
+    fclose(f);
+    return ok ? resident * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+}
+
+// Скидає пік RSS (VmHWM) до поточного значення, щоб завантажена траса
+// і тимчасова копія для сортування не потрапили в пік відтворення
+static int reset_peak_rss(void) {
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f == NULL) return 0;
+    int ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+// Пік RSS з моменту скидання; ru_maxrss - пік за весь час процесу
+static long peak_rss_kib(void) {
+    FILE* f = fopen("/proc/self/status", "r");
+    char line[128];
+    long kib = -1;
+    while (f != NULL && fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "VmHWM: %ld kB", &kib) == 1) break;
+    }
+    if (f != NULL) fclose(f);
+    if (kib < 0) {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        kib = (long)ru.ru_maxrss;
+    }
+    return kib;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: mem_replay [-a mem|glibc] [-p best|first|next|good] [-s arena_size] trace.bin\n");
+}
+
+int main(int argc, char** argv) {
+    Allocator mem = {"mem", mem_alloc, mem_free, mem_realloc};
+    Allocator libc = {"glibc", malloc, free, realloc};
+    Allocator* a = &mem;
+    MemConfig config = {0};
+    const char* path = NULL;
+
+    config.policy = MEM_POLICY_BEST_FIT;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            a = strcmp(argv[++i], "glibc") == 0 ? &libc : &mem;
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            const char* p = argv[++i];
+            config.policy = strcmp(p, "first") == 0 ? MEM_POLICY_FIRST_FIT :
+                            strcmp(p, "next") == 0 ? MEM_POLICY_NEXT_FIT :
+                            strcmp(p, "good") == 0 ? MEM_POLICY_GOOD_FIT : MEM_POLICY_BEST_FIT;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            config.arena_size = (size_t)strtoull(argv[++i], NULL, 0);
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        usage();
+        return 2;
+    }
+
+    size_t count = 0;
+    TraceRecord* records = load_trace(path, &count);
+    if (records == NULL) return 1;
+
+    if (a == &mem) mem_init_config(&config);
+
+    // Пам'ять траси - не заслуга алокатора: міряємо приріст над станом після
+    // завантаження. Без скидання піку RSS вибирається кожні 1024 записи.
+    long base_rss = rss_kib();
+    int peak_reset = base_rss >= 0 && reset_peak_rss();
+    long peak_rss = base_rss;
+
+    size_t live = 0;
+    size_t peak_live = 0;
+    size_t missing = 0;
+    double start = now_sec();
+
+    for (size_t i = 0; i < count; i++) {
+        const TraceRecord* r = &records[i];
+        Replayed* e;
+
+        switch (r->op) {
+        case TRACE_OP_ALLOC: {
+            void* p = a->alloc(r->size);
+            if (r->ptr != 0 && p != NULL) {
+                table_put(r->ptr, p, r->size);
+                live += r->size;
+            }
+            break;
+        }
+        case TRACE_OP_FREE:
+            e = table_get(r->ptr);
+            if (e == NULL) {
+                missing++;
+                break;
+            }
+            a->free(e->ptr);
+            live -= e->size;
+            table_del(e);
+            break;
+        case TRACE_OP_REALLOC: {
+            void* old = NULL;
+            e = table_get(r->old_ptr);
+            if (e != NULL) {
+                old = e->ptr;
+                live -= e->size;
+                table_del(e);
+            } else if (r->old_ptr != 0) {
+                missing++;
+            }
+            void* p = a->realloc(old, r->size);
+            if (r->ptr != 0 && p != NULL) {
+                table_put(r->ptr, p, r->size);
+                live += r->size;
+            }
+            break;
+        }
+        }
+        if (live > peak_live) peak_live = live;
+        if (!peak_reset && base_rss >= 0 && (i & 1023) == 0) {
+            long rss = rss_kib();
+            if (rss > peak_rss) peak_rss = rss;
+        }
+    }
+
+    double elapsed = now_sec() - start;
+    if (peak_reset) {
+        peak_rss = peak_rss_kib();
+    } else if (base_rss >= 0) {
+        long rss = rss_kib();
+        if (rss > peak_rss) peak_rss = rss;
+    }
+
+    printf("allocator:     %s\n", a->name);
+    printf("records:       %zu (%zu unmatched)\n", count, missing);
+    printf("time:          %.3f s (%.1f ns/op)\n", elapsed, count ? elapsed * 1e9 / (double)count : 0.0);
+    if (base_rss >= 0) {
+        printf("peak RSS:      +%ld KiB over %ld KiB after loading%s\n", peak_rss - base_rss, base_rss,
+               peak_reset ? "" : " (sampled)");
+    } else {
+        printf("peak RSS:      n/a\n");
+    }
+    printf("peak live:     %zu KiB, live at end: %zu KiB\n", peak_live / 1024, live / 1024);
+
+    if (a == &mem) {
+        MemStats st;
+        mem_stats(&st);
+        printf("arenas:        %zu (%zu KiB mapped)\n", st.arena_count, st.mapped_bytes / 1024);
+        printf("utilization:   %.3f\n", st.mapped_bytes ? (double)live / (double)st.mapped_bytes : 0.0);
+        printf("ext. frag.:    %.3f\n", st.free_bytes ? 1.0 - (double)st.largest_free / (double)st.free_bytes : 0.0);
+    } else {
+        printf("arenas:        n/a\n");
+    }
+
+    free(records);
+    free(table);
+    return 0;
+}
\ No newline at end of file
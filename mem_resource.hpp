@@ -0,0 +1,87 @@
+// mem_resource.hpp - C++-обгортки над алокатором:
+//   mem::resource     - std::pmr::memory_resource для pmr-контейнерів;
+//   mem::allocator<T> - STL-алокатор без стану для звичайних контейнерів.
+// Обидва передають розмір у deallocate, щоб звільнення могло обійтися без
+// читання заголовка блока.
+#ifndef MEM_RESOURCE_HPP
+#define MEM_RESOURCE_HPP
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include "allocator.h"
+
+namespace mem {
+
+namespace detail {
+
+inline void* allocate(std::size_t bytes, std::size_t alignment) {
+    // mem_alloc(0) повертає NULL, а C++ вимагає унікальний вказівник
+    if (bytes == 0) bytes = 1;
+    void* p = alignment <= alignof(std::max_align_t) ? mem_alloc(bytes)
+                                                     : mem_alloc_aligned(alignment, bytes);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+inline void deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    // Блоки з mem_alloc_aligned можуть бути меншими за клас свого розміру
+    if (alignment > alignof(std::max_align_t)) {
+        mem_free(p);
+        return;
+    }
+    mem_free_sized(p, bytes == 0 ? 1 : bytes);
+}
+
+} // namespace detail
+
+class resource : public std::pmr::memory_resource {
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return detail::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        detail::deallocate(p, bytes, alignment);
+    }
+
+    // Усі екземпляри працюють з тією самою купою
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return dynamic_cast<const resource*>(&other) != nullptr;
+    }
+};
+
+// Спільний екземпляр, наприклад для std::pmr::set_default_resource
+inline resource* default_resource() noexcept {
+    static resource instance;
+    return &instance;
+}
+
+template <class T>
+struct allocator {
+    using value_type = T;
+
+    allocator() noexcept = default;
+    template <class U>
+    allocator(const allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(detail::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        detail::deallocate(p, n * sizeof(T), alignof(T));
+    }
+};
+
+template <class T, class U>
+bool operator==(const allocator<T>&, const allocator<U>&) noexcept { return true; }
+
+template <class T, class U>
+bool operator!=(const allocator<T>&, const allocator<U>&) noexcept { return false; }
+
+} // namespace mem
+
+#endif
\ No newline at end of file
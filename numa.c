@@ -0,0 +1,81 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include "numa.h"
+#include <stdio.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+int numa_node_count(void) {
+    // Формат файлу: "0" або "0-1" або "0,2-3"; беремо найбільший номер
+    FILE* f = fopen("/sys/devices/system/node/online", "r");
+    if (f == NULL) return 1;
+
+    int max_node = 0;
+    int value = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+        } else {
+            if (value > max_node) max_node = value;
+            value = 0;
+        }
+    }
+    if (value > max_node) max_node = value;
+    fclose(f);
+    return max_node + 1;
+}
+
+int numa_current_node(void) {
+    unsigned cpu = 0;
+    unsigned node = 0;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    // glibc бере getcpu з vDSO, без системного виклику
+    if (getcpu(&cpu, &node) != 0) return 0;
+#else
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return 0;
+#endif
+    return (int)node;
+}
+
+int numa_current_cpu(void) {
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu;
+}
+
+int numa_bind(void* addr, size_t len, int node) {
+    if (node < 0 || node >= (int)(8 * sizeof(unsigned long))) return -1;
+    unsigned long mask = 1ul << node;
+    return (int)syscall(SYS_mbind, addr, len, MPOL_BIND, &mask, 8 * sizeof(mask), 0);
+}
+
+#else
+
+int numa_node_count(void) {
+    return 1;
+}
+
+int numa_current_node(void) {
+    return 0;
+}
+
+int numa_current_cpu(void) {
+    return 0;
+}
+
+int numa_bind(void* addr, size_t len, int node) {
+    (void)addr;
+    (void)len;
+    (void)node;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stddef.h>
+
+/* Найбільша кількість NUMA-вузлів, для яких алокатор тримає окремі купи */
+#ifndef MEM_MAX_NUMA_NODES
+#define MEM_MAX_NUMA_NODES 8
+#endif
+
+/* Кількість вузлів у системі (1, якщо NUMA недоступна) */
+int numa_node_count(void);
+
+/* Вузол процесора, на якому зараз виконується потік (0, якщо невідомо) */
+int numa_current_node(void);
+
+/* Процесор, на якому зараз виконується потік (0, якщо невідомо) */
+int numa_current_cpu(void);
+
+/* Прив'язати сторінки діапазону до вузла; 0 - успіх, -1 - помилка */
+int numa_bind(void* addr, size_t len, int node);
+
+#endif
@@ -0,0 +1,315 @@
+#include "page.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#define PAGE_HUGE_SIZE ((size_t)2 * 1024 * 1024)
+
+static size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+void* page_map(const PageProvider* pages, size_t size, size_t align) {
+    void* ptr = pages->reserve(pages->ctx, size, align);
+    if (ptr != NULL && !pages->commit(pages->ctx, ptr, size)) {
+        pages->release(pages->ctx, ptr, size);
+        return NULL;
+    }
+    return ptr;
+}
+
+void page_unmap(const PageProvider* pages, void* ptr, size_t size) {
+    pages->release(pages->ctx, ptr, size);
+}
+
+// Системні виклики
+#ifdef _WIN32
+size_t page_os_size(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+// Резервуємо із запасом, звільняємо і займаємо вирівняну адресу;
+// інший потік може встигнути зайняти її, тоді пробуємо ще раз
+static void* os_reserve(void* ctx, size_t size, size_t align) {
+    (void)ctx;
+    if (align <= 64 * 1024) return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+    for (int attempt = 0; attempt < 16; attempt++) {
+        char* probe = (char*)VirtualAlloc(NULL, size + align, MEM_RESERVE, PAGE_NOACCESS);
+        if (probe == NULL) return NULL;
+        VirtualFree(probe, 0, MEM_RELEASE);
+        void* aligned = (void*)align_up((uintptr_t)probe, align);
+        void* ptr = VirtualAlloc(aligned, size, MEM_RESERVE, PAGE_NOACCESS);
+        if (ptr != NULL) return ptr;
+    }
+    return NULL;
+}
+
+static bool os_commit(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+static void os_decommit(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    VirtualAlloc(ptr, size, MEM_RESET, PAGE_READWRITE);
+}
+
+static void os_release(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+// Великі сторінки Windows потребують привілею і окремого резервування
+static bool os_advise(void* ctx, void* ptr, size_t size, PageAdvice advice) {
+    (void)ctx;
+    if (advice == PAGE_ADVICE_LOCK) return VirtualLock(ptr, size) != 0;
+    return false;
+}
+
+static uint64_t clock_ns(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)frequency.QuadPart);
+}
+#else
+size_t page_os_size(void) {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+// Відображаємо із запасом і відрізаємо надлишок до і після вирівняної ділянки
+static void* os_reserve(void* ctx, size_t size, size_t align) {
+    (void)ctx;
+    size_t page = page_os_size();
+    size_t mapped = align_up(size, page);
+    if (align <= page) {
+        void* ptr = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return ptr == MAP_FAILED ? NULL : ptr;
+    }
+
+    void* map = mmap(NULL, mapped + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) return NULL;
+    char* raw = (char*)map;
+    char* aligned = (char*)align_up((uintptr_t)raw, align);
+    if (aligned > raw) munmap(raw, (size_t)(aligned - raw));
+    char* tail = aligned + mapped;
+    char* raw_end = raw + mapped + align;
+    if (raw_end > tail) munmap(tail, (size_t)(raw_end - tail));
+    return aligned;
+}
+
+static bool os_commit(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    (void)ptr;
+    (void)size;
+    return true;
+}
+
+static void os_decommit(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    madvise(ptr, size, MADV_DONTNEED);
+}
+
+static void os_release(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    munmap(ptr, size);
+}
+
+static bool os_advise(void* ctx, void* ptr, size_t size, PageAdvice advice) {
+    (void)ctx;
+    if (advice == PAGE_ADVICE_LOCK) return mlock(ptr, size) == 0;
+#ifdef MADV_HUGEPAGE
+    return madvise(ptr, size, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+}
+
+static uint64_t clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+const PageProvider page_mmap = {"mmap", os_reserve, os_commit, os_decommit, os_release, os_advise, NULL};
+
+// Великі сторінки
+static void* huge_reserve(void* ctx, size_t size, size_t align) {
+    if (size < PAGE_HUGE_SIZE) return os_reserve(ctx, size, align);
+    void* ptr = os_reserve(ctx, size, align > PAGE_HUGE_SIZE ? align : PAGE_HUGE_SIZE);
+    if (ptr != NULL) os_advise(ctx, ptr, size, PAGE_ADVICE_HUGE);
+    return ptr;
+}
+
+const PageProvider page_huge = {"huge", huge_reserve, os_commit, os_decommit, os_release, os_advise, NULL};
+
+// Статичний буфер
+
+static bool static_run_free(const PageStatic* st, size_t first, size_t count) {
+    for (size_t i = first; i < first + count; i++) {
+        if (st->map[i / 64] & ((uint64_t)1 << (i % 64))) return false;
+    }
+    return true;
+}
+
+static void static_mark(PageStatic* st, size_t first, size_t count, bool busy) {
+    for (size_t i = first; i < first + count; i++) {
+        if (busy) {
+            st->map[i / 64] |= (uint64_t)1 << (i % 64);
+        } else {
+            st->map[i / 64] &= ~((uint64_t)1 << (i % 64));
+        }
+    }
+}
+
+// Перший вільний проміжок на вирівняній адресі
+static void* static_reserve(void* ctx, size_t size, size_t align) {
+    PageStatic* st = (PageStatic*)ctx;
+    size_t count = align_up(size, PAGE_STATIC_UNIT) / PAGE_STATIC_UNIT;
+    if (align < PAGE_STATIC_UNIT) align = PAGE_STATIC_UNIT;
+    size_t step = align / PAGE_STATIC_UNIT;
+    size_t first = (align_up((uintptr_t)st->base, align) - (uintptr_t)st->base) / PAGE_STATIC_UNIT;
+
+    void* result = NULL;
+    spin_lock(&st->lock);
+    for (size_t i = first; count > 0 && i + count <= st->units; i += step) {
+        if (static_run_free(st, i, count)) {
+            static_mark(st, i, count, true);
+            result = st->base + i * PAGE_STATIC_UNIT;
+            break;
+        }
+    }
+    spin_unlock(&st->lock);
+    return result;
+}
+
+static bool static_commit(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    (void)ptr;
+    (void)size;
+    return true;
+}
+
+// Повертати сторінки нікому: буфер і так належить програмі
+static void static_decommit(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    (void)ptr;
+    (void)size;
+}
+
+static void static_release(void* ctx, void* ptr, size_t size) {
+    PageStatic* st = (PageStatic*)ctx;
+    size_t first = (size_t)((char*)ptr - st->base) / PAGE_STATIC_UNIT;
+    spin_lock(&st->lock);
+    static_mark(st, first, align_up(size, PAGE_STATIC_UNIT) / PAGE_STATIC_UNIT, false);
+    spin_unlock(&st->lock);
+}
+
+static bool static_advise(void* ctx, void* ptr, size_t size, PageAdvice advice) {
+    (void)ctx;
+    (void)ptr;
+    (void)size;
+    (void)advice;
+    return false;
+}
+
+bool page_static_init(PageStatic* st, void* buffer, size_t size) {
+    uintptr_t start = align_up((uintptr_t)buffer, PAGE_STATIC_UNIT);
+    uintptr_t end = ((uintptr_t)buffer + size) & ~(uintptr_t)(PAGE_STATIC_UNIT - 1);
+    if (end <= start) return false;
+
+    size_t units = (size_t)(end - start) / PAGE_STATIC_UNIT;
+    size_t map_bytes = (units + 63) / 64 * sizeof(uint64_t);
+    size_t map_units = align_up(map_bytes, PAGE_STATIC_UNIT) / PAGE_STATIC_UNIT;
+    if (map_units >= units) return false;
+
+    memset(st, 0, sizeof(*st));
+    st->base = (char*)start;
+    st->units = units;
+    st->map = (uint64_t*)start;
+    memset(st->map, 0, map_bytes);
+    static_mark(st, 0, map_units, true);
+
+    PageProvider provider = {"static", static_reserve, static_commit, static_decommit,
+                             static_release, static_advise, st};
+    st->provider = provider;
+    return true;
+}
+
+// Лічильник з імітацією затримки
+
+static uint64_t counting_begin(PageCounting* pc) {
+    uint64_t start = clock_ns();
+    if (pc->delay_ns > 0) {
+        while (clock_ns() - start < pc->delay_ns) {
+        }
+    }
+    return start;
+}
+
+static void counting_end(PageCounting* pc, PageOp op, size_t size, uint64_t start) {
+    uint64_t elapsed = clock_ns() - start;
+    spin_lock(&pc->lock);
+    pc->calls[op]++;
+    pc->bytes[op] += size;
+    pc->total_ns[op] += elapsed;
+    spin_unlock(&pc->lock);
+}
+
+static void* counting_reserve(void* ctx, size_t size, size_t align) {
+    PageCounting* pc = (PageCounting*)ctx;
+    uint64_t start = counting_begin(pc);
+    void* ptr = pc->inner->reserve(pc->inner->ctx, size, align);
+    counting_end(pc, PAGE_OP_RESERVE, size, start);
+    return ptr;
+}
+
+static bool counting_commit(void* ctx, void* ptr, size_t size) {
+    PageCounting* pc = (PageCounting*)ctx;
+    uint64_t start = counting_begin(pc);
+    bool ok = pc->inner->commit(pc->inner->ctx, ptr, size);
+    counting_end(pc, PAGE_OP_COMMIT, size, start);
+    return ok;
+}
+
+static void counting_decommit(void* ctx, void* ptr, size_t size) {
+    PageCounting* pc = (PageCounting*)ctx;
+    uint64_t start = counting_begin(pc);
+    pc->inner->decommit(pc->inner->ctx, ptr, size);
+    counting_end(pc, PAGE_OP_DECOMMIT, size, start);
+}
+
+static void counting_release(void* ctx, void* ptr, size_t size) {
+    PageCounting* pc = (PageCounting*)ctx;
+    uint64_t start = counting_begin(pc);
+    pc->inner->release(pc->inner->ctx, ptr, size);
+    counting_end(pc, PAGE_OP_RELEASE, size, start);
+}
+
+static bool counting_advise(void* ctx, void* ptr, size_t size, PageAdvice advice) {
+    PageCounting* pc = (PageCounting*)ctx;
+    uint64_t start = counting_begin(pc);
+    bool ok = pc->inner->advise(pc->inner->ctx, ptr, size, advice);
+    counting_end(pc, PAGE_OP_ADVISE, size, start);
+    return ok;
+}
+
+void page_counting_init(PageCounting* pc, const PageProvider* inner, uint64_t delay_ns) {
+    memset(pc, 0, sizeof(*pc));
+    pc->inner = inner;
+    pc->delay_ns = delay_ns;
+    PageProvider provider = {"counting", counting_reserve, counting_commit, counting_decommit,
+                             counting_release, counting_advise, pc};
+    pc->provider = provider;
+}
\ No newline at end of file
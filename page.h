@@ -0,0 +1,90 @@
+#ifndef PAGE_H
+#define PAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "spinlock.h"
+
+/*
+ * Постачальник сторінок - єдиний шар між купою (і TLSF) та ОС.
+ *   reserve  - ділянка адрес розміру size, вирівняна на align (степінь
+ *              двійки; менше сторінки - вирівнювання сторінки);
+ *   commit   - зробити ділянку доступною для читання і запису;
+ *   decommit - віддати фізичні сторінки, лишивши ділянку доступною
+ *              (вміст після цього невизначений);
+ *   release  - зняти ділянку, отриману з reserve;
+ *   advise   - підказка (PageAdvice); false - не підтримується або ОС відмовила.
+ * Першим аргументом кожен виклик отримує ctx постачальника. Купа
+ * викликає постачальника під своїм замком, але різні купи - паралельно.
+ */
+typedef enum PageAdvice {
+    PAGE_ADVICE_HUGE,  /* великі сторінки */
+    PAGE_ADVICE_LOCK   /* закріпити в пам'яті */
+} PageAdvice;
+
+typedef struct PageProvider {
+    const char* name;
+    void* (*reserve)(void* ctx, size_t size, size_t align);
+    bool (*commit)(void* ctx, void* ptr, size_t size);
+    void (*decommit)(void* ctx, void* ptr, size_t size);
+    void (*release)(void* ctx, void* ptr, size_t size);
+    bool (*advise)(void* ctx, void* ptr, size_t size, PageAdvice advice);
+    void* ctx;
+} PageProvider;
+
+/* Розмір сторінки ОС */
+size_t page_os_size(void);
+
+/* reserve + commit; NULL, якщо не вдалося одне з двох */
+void* page_map(const PageProvider* pages, size_t size, size_t align);
+void page_unmap(const PageProvider* pages, void* ptr, size_t size);
+
+/* mmap/munmap або VirtualAlloc/VirtualFree. На Linux reserve одразу дає
+ * доступні сторінки (ядро виділяє їх при першому дотику), commit порожній */
+extern const PageProvider page_mmap;
+
+/* Те саме з великими сторінками: ділянки від 2 МіБ вирівнюються на 2 МіБ
+ * і позначаються для прозорих великих сторінок (Linux; деінде - як page_mmap) */
+extern const PageProvider page_huge;
+
+/* Наперед виділений буфер для систем без mmap: ділянки нарізаються
+ * сторінками PAGE_STATIC_UNIT з бітової карти на початку буфера */
+#define PAGE_STATIC_UNIT 4096
+
+typedef struct PageStatic {
+    PageProvider provider;
+    char* base;
+    size_t units;
+    uint64_t* map;  /* біт на одиницю, 1 - зайнята */
+    spinlock_t lock;
+} PageStatic;
+
+/* false - буфер замалий навіть для власної карти */
+bool page_static_init(PageStatic* st, void* buffer, size_t size);
+
+/* Обгортка для тестів і бенчмарків: рахує виклики, байти і час кожної
+ * операції іншого постачальника і може додавати до кожного виклику
+ * затримку delay_ns, імітуючи повільну ОС */
+typedef enum PageOp {
+    PAGE_OP_RESERVE,
+    PAGE_OP_COMMIT,
+    PAGE_OP_DECOMMIT,
+    PAGE_OP_RELEASE,
+    PAGE_OP_ADVISE,
+    PAGE_OP_COUNT
+} PageOp;
+
+typedef struct PageCounting {
+    PageProvider provider;
+    const PageProvider* inner;
+    uint64_t delay_ns;
+    size_t calls[PAGE_OP_COUNT];
+    size_t bytes[PAGE_OP_COUNT];
+    uint64_t total_ns[PAGE_OP_COUNT];
+    spinlock_t lock;
+} PageCounting;
+
+void page_counting_init(PageCounting* pc, const PageProvider* inner, uint64_t delay_ns);
+
+#endif
\ No newline at end of file
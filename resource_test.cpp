@@ -0,0 +1,69 @@
+// resource_test.cpp - mem::resource і mem::allocator зі стандартними контейнерами під mem_check
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "mem_resource.hpp"
+
+struct alignas(64) Wide {
+    char bytes[64];
+};
+
+static size_t arenas() {
+    MemStats stats;
+    mem_stats(&stats);
+    return stats.arena_count;
+}
+
+static void test_pmr_containers() {
+    printf("=== PMR CONTAINERS ===\n");
+    mem_init(4096, 64 * 1024);
+    size_t before = arenas();
+    {
+        std::pmr::vector<int> v(mem::default_resource());
+        for (int i = 0; i < 100000; i++) v.push_back(i);
+        assert(arenas() > before);
+
+        std::pmr::map<int, std::pmr::string> m(mem::default_resource());
+        for (int i = 0; i < 5000; i++) m.emplace(i, std::pmr::string(40, (char)('a' + i % 26)));
+        for (int i = 0; i < 5000; i += 2) m.erase(i);
+        assert(m.size() == 2500 && m.at(1).compare(std::string(40, 'b').c_str()) == 0);
+        assert(v[99999] == 99999);
+        assert(mem_check() == 0);
+
+        // Надвирівняні запити йдуть через mem_alloc_aligned
+        std::pmr::vector<Wide> wide(mem::default_resource());
+        wide.resize(100);
+        assert(((uintptr_t)wide.data() & 63) == 0);
+    }
+    assert(mem_check() == 0);
+    printf("✓ vector, map and strings on mem::resource\n");
+}
+
+static void test_stl_allocator() {
+    printf("=== STL ALLOCATOR ADAPTOR ===\n");
+    mem_init(4096, 64 * 1024);
+    {
+        std::map<int, int, std::less<int>, mem::allocator<std::pair<const int, int>>> m;
+        for (int i = 0; i < 20000; i++) m[i * 7 % 20011] = i;
+        for (int i = 0; i < 20000; i += 3) m.erase(i * 7 % 20011);
+        assert(m.size() == 13333);
+        assert(mem_check() == 0);
+
+        std::vector<Wide, mem::allocator<Wide>> wide(33);
+        assert(((uintptr_t)wide.data() & 63) == 0);
+    }
+    assert(mem_check() == 0);
+    printf("✓ std::map and std::vector with mem::allocator\n");
+}
+
+int main() {
+    test_pmr_containers();
+    test_stl_allocator();
+    mem_init(4096, 64 * 1024);
+    printf("=== ALL RESOURCE TESTS PASSED ===\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,499 @@
+#include "shared_heap.h"
+#include "block.h"
+#include "size_class.h"
+#include "spinlock.h"
+#include "hardened.h"
+#include "latency.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if MEM_HARDENED
+#define CANARY_RESERVE MEM_CANARY_SIZE
+#else
+#define CANARY_RESERVE 0
+#endif
+
+#define ALIGN(size) align_up(size, MAX_ALIGN)
+
+/* Кошики: спершу по одному на клас розміру, далі - по степенях двійки */
+#define SHARED_BINS (SIZE_CLASS_COUNT + 48)
+
+typedef struct SharedHeader {
+    uint64_t magic;
+    uint32_t version;
+    /* Розмір заголовка блока: hardened і звичайна збірки несумісні */
+    uint32_t block_header_size;
+    uint64_t size;
+    /* Межа вже нарізаних арен; далі - ще не використана частина */
+    uint64_t top;
+    uint64_t arena_size;
+    uint64_t arena_head;
+    uint64_t arena_count;
+    uint64_t root;
+    uint64_t bins[SHARED_BINS];
+    spinlock_t lock;
+} SharedHeader;
+
+typedef struct SharedArena {
+    uint64_t size;
+    uint64_t next;
+} SharedArena;
+
+/* Зв'язки вільного блока в кошику лежать у його payload */
+typedef struct SharedLinks {
+    uint64_t next;
+    uint64_t prev;
+} SharedLinks;
+
+#define SHARED_HEADER_SIZE ALIGN(sizeof(SharedHeader))
+#define SHARED_ARENA_HEADER_SIZE ALIGN(sizeof(SharedArena))
+
+static char* base = NULL;
+static size_t mapped_size = 0;
+
+static SharedHeader* header(void) {
+    return (SharedHeader*)base;
+}
+
+static uint64_t off(void* p) {
+    return p == NULL ? 0 : (uint64_t)((char*)p - base);
+}
+
+static void* at(uint64_t offset) {
+    return offset == 0 ? NULL : base + offset;
+}
+
+static SharedLinks* links(Block* b) {
+    return (SharedLinks*)block_payload(b);
+}
+
+static unsigned highest_bit(size_t v) {
+    unsigned e = 0;
+    while (v >>= 1) e++;
+    return e;
+}
+
+// Кошик, у який кладеться вільний блок: усі блоки кошика не менші за його нижню межу
+static unsigned bin_of(size_t size) {
+    if (size <= SIZE_CLASS_MAX) {
+        unsigned cls = size_class_of(size);
+        if (size_class_size[cls] > size) cls--;
+        return cls;
+    }
+    unsigned bin = SIZE_CLASS_COUNT + highest_bit(size) - highest_bit(SIZE_CLASS_MAX);
+    return bin < SHARED_BINS ? bin : SHARED_BINS - 1;
+}
+
+static void bin_insert(Block* b) {
+    SharedHeader* h = header();
+    unsigned bin = bin_of(block_get_size(b));
+    SharedLinks* l = links(b);
+    l->prev = 0;
+    l->next = h->bins[bin];
+    if (l->next != 0) links((Block*)at(l->next))->prev = off(b);
+    h->bins[bin] = off(b);
+}
+
+static void bin_remove(Block* b) {
+    SharedHeader* h = header();
+    SharedLinks* l = links(b);
+    if (l->prev != 0) {
+        links((Block*)at(l->prev))->next = l->next;
+    } else {
+        h->bins[bin_of(block_get_size(b))] = l->next;
+    }
+    if (l->next != 0) links((Block*)at(l->next))->prev = l->prev;
+}
+
+static Block* next_block(Block* b) {
+    if (block_get_flag_last(b)) return NULL;
+    return (Block*)((char*)b + block_get_size(b));
+}
+
+// Дрібні кошики точні за класом; у кошиках степенів двійки - перший придатний
+static Block* bin_find(size_t total_size) {
+    SharedHeader* h = header();
+    unsigned start = bin_of(total_size);
+    for (unsigned bin = start; bin < SHARED_BINS; bin++) {
+        for (uint64_t o = h->bins[bin]; o != 0; o = links((Block*)at(o))->next) {
+            Block* b = (Block*)at(o);
+            if (block_get_size(b) >= total_size) return b;
+            if (bin != start) break;
+        }
+    }
+    return NULL;
+}
+
+static void split(Block* b, size_t total_size) {
+    size_t size = block_get_size(b);
+    if (size < total_size + block_header_size() * 2) return;
+
+    Block* rest = (Block*)((char*)b + total_size);
+    block_initialize(rest, size - total_size, false, false, block_get_flag_last(b));
+    block_set_size_prev(rest, total_size);
+    Block* after = next_block(rest);
+    if (after != NULL) block_set_size_prev(after, size - total_size);
+
+    block_set_size(b, total_size);
+    block_set_flag_last(b, false);
+    bin_insert(rest);
+}
+
+// Нова арена з ще не використаної частини відображення; інший процес міг
+// збільшити файл, але нарізати можна лише те, що відображено в цьому
+static Block* new_arena(size_t total_size) {
+    SharedHeader* h = header();
+    size_t size = h->arena_size;
+    if (total_size + SHARED_ARENA_HEADER_SIZE > size) size = ALIGN(total_size + SHARED_ARENA_HEADER_SIZE);
+    size_t limit = h->size < mapped_size ? (size_t)h->size : mapped_size;
+    if (h->top + size > limit) return NULL;
+
+    SharedArena* arena = (SharedArena*)at(h->top);
+    arena->size = size;
+    arena->next = h->arena_head;
+    h->arena_head = h->top;
+    h->arena_count++;
+    h->top += size;
+
+    Block* b = (Block*)((char*)arena + SHARED_ARENA_HEADER_SIZE);
+    block_initialize(b, size - SHARED_ARENA_HEADER_SIZE, false, true, true);
+    latency_path = size > h->arena_size ? MEM_LAT_LARGE : MEM_LAT_ARENA;
+    return b;
+}
+
+static bool valid_header(SharedHeader* h, size_t size) {
+    return h->magic == SHARED_MAGIC && h->version == SHARED_VERSION &&
+           h->block_header_size == block_header_size() &&
+           h->top <= size && h->top <= h->size;
+}
+
+#ifdef _WIN32
+
+bool shared_open(const char* path, int fd, size_t size, size_t arena_size) {
+    (void)path;
+    (void)fd;
+    (void)size;
+    (void)arena_size;
+    fprintf(stderr, "shared heap: not supported on this platform\n");
+    return false;
+}
+
+void shared_close(void) {
+}
+
+static bool cover_heap(void) {
+    return true;
+}
+
+#else
+
+// Відображення лежить на початку резерву адрес, тож купу, збільшену іншим
+// процесом, можна дорощувати на місці; дескриптор файлу - для цього ж
+#define SHARED_RESERVE ((size_t)1 << (sizeof(void*) > 4 ? 36 : 28))
+
+static int map_fd = -1;
+static size_t reserved_size = 0;
+
+bool shared_open(const char* path, int fd, size_t size, size_t arena_size) {
+    shared_close();
+
+    int own_fd = -1;
+    if (path != NULL) {
+        own_fd = open(path, O_RDWR | O_CREAT, 0600);
+        if (own_fd < 0) {
+            perror("shared heap: open");
+            return false;
+        }
+        fd = own_fd;
+    }
+
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    bool fresh = ok && st.st_size == 0;
+    if (ok && size == 0) size = (size_t)st.st_size;
+    size = align_up(size, (size_t)sysconf(_SC_PAGESIZE));
+    ok = ok && size >= SHARED_HEADER_SIZE + arena_size;
+    // Наявний файл можна лише збільшити
+    if (ok && (off_t)size > st.st_size) ok = ftruncate(fd, (off_t)size) == 0;
+
+    size_t reserve = size > SHARED_RESERVE ? size : SHARED_RESERVE;
+    void* area = ok ? mmap(NULL, reserve, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)
+                    : MAP_FAILED;
+    void* map = area != MAP_FAILED ? mmap(area, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0)
+                                   : MAP_FAILED;
+    if (map != MAP_FAILED) map_fd = dup(fd);
+    if (own_fd >= 0) close(own_fd);
+    if (map == MAP_FAILED) {
+        if (area != MAP_FAILED) munmap(area, reserve);
+        fprintf(stderr, "shared heap: cannot map %lu bytes\n", (unsigned long)size);
+        return false;
+    }
+    reserved_size = reserve;
+
+    base = (char*)map;
+    mapped_size = size;
+    SharedHeader* h = header();
+    if (fresh) {
+        memset(h, 0, sizeof(*h));
+        h->magic = SHARED_MAGIC;
+        h->version = SHARED_VERSION;
+        h->block_header_size = (uint32_t)block_header_size();
+        h->top = SHARED_HEADER_SIZE;
+        h->arena_size = arena_size;
+    } else if (!valid_header(h, size)) {
+        fprintf(stderr, "shared heap: not a compatible heap file\n");
+        shared_close();
+        return false;
+    }
+    // Менше відображення не зменшує купу для інших процесів
+    if (size > h->size) h->size = size;
+    return true;
+}
+
+void shared_close(void) {
+    if (base != NULL) munmap(base, reserved_size);
+    if (map_fd >= 0) close(map_fd);
+    base = NULL;
+    mapped_size = 0;
+    reserved_size = 0;
+    map_fd = -1;
+}
+
+// Під замком: якщо інший процес збільшив купу, дописати відображення в
+// резерв одразу за наявним (адреси блоків не змінюються). false - арени за
+// межею відображення вже нарізані, а дорости не вдалося, тож кошиків чіпати не можна
+static bool cover_heap(void) {
+    SharedHeader* h = header();
+    if (h->size <= mapped_size) return true;
+
+    size_t target = h->size < reserved_size ? (size_t)h->size : reserved_size;
+    if (target > mapped_size && map_fd >= 0 &&
+        mmap(base + mapped_size, target - mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+             map_fd, (off_t)mapped_size) != MAP_FAILED) {
+        mapped_size = target;
+    }
+    return h->top <= mapped_size;
+}
+
+#endif
+
+void* shared_alloc(size_t size) {
+    if (size == 0 || size > SIZE_MAX / 2 || base == NULL) return NULL;
+
+    size_t total_size = ALIGN(size + block_header_size() + CANARY_RESERVE);
+    if (total_size < block_header_size() * 2) total_size = block_header_size() * 2;
+    if (total_size <= SIZE_CLASS_MAX) total_size = size_class_size[size_class_of(total_size)];
+
+    SharedHeader* h = header();
+    spin_lock(&h->lock);
+    if (!cover_heap()) {
+        spin_unlock(&h->lock);
+        return NULL;
+    }
+    Block* b = bin_find(total_size);
+    if (b != NULL) {
+        bin_remove(b);
+        latency_path = MEM_LAT_TREE;
+    } else {
+        b = new_arena(total_size);
+    }
+    if (b != NULL) {
+        split(b, total_size);
+        block_set_flag_busy(b, true);
+#if MEM_HARDENED
+        hardened_arm(b, size);
+#endif
+    }
+    spin_unlock(&h->lock);
+    return b != NULL ? block_payload(b) : NULL;
+}
+
+void shared_free(void* ptr) {
+    if (ptr == NULL) return;
+
+    Block* b = block_from_payload(ptr);
+    SharedHeader* h = header();
+#if MEM_HARDENED
+    if ((char*)ptr < base + SHARED_HEADER_SIZE || (char*)ptr >= base + h->top) {
+        hardened_report("free of pointer not owned by shared heap", ptr);
+    }
+    hardened_check_busy(b);
+    hardened_poison(b);
+#endif
+
+    spin_lock(&h->lock);
+    // Без доступу до чужих арен блок лишається зайнятим, а не ламає кошики
+    if (!cover_heap()) {
+        spin_unlock(&h->lock);
+        return;
+    }
+    block_set_flag_busy(b, false);
+
+    Block* next = next_block(b);
+    if (next != NULL && !block_get_flag_busy(next)) {
+        bin_remove(next);
+        block_set_flag_last(b, block_get_flag_last(next));
+        block_set_size(b, block_get_size(b) + block_get_size(next));
+    }
+    if (!block_get_flag_first(b)) {
+        Block* prev = block_prev(NULL, b);
+        if (!block_get_flag_busy(prev)) {
+            bin_remove(prev);
+            block_set_flag_last(prev, block_get_flag_last(b));
+            block_set_size(prev, block_get_size(prev) + block_get_size(b));
+            b = prev;
+        }
+    }
+    next = next_block(b);
+    if (next != NULL) block_set_size_prev(next, block_get_size(b));
+
+    bin_insert(b);
+    latency_path = MEM_LAT_TREE;
+    spin_unlock(&h->lock);
+}
+
+void* shared_realloc(void* ptr, size_t size) {
+    if (ptr == NULL) return shared_alloc(size);
+    if (size == 0) {
+        shared_free(ptr);
+        return NULL;
+    }
+
+    Block* b = block_from_payload(ptr);
+    size_t old_size = block_get_size(b) - block_header_size() - CANARY_RESERVE;
+#if MEM_HARDENED
+    hardened_check_busy(b);
+    if (size <= old_size) {
+        hardened_arm(b, size);
+        latency_path = MEM_LAT_FAST;
+        return ptr;
+    }
+    old_size = b->requested;
+#else
+    if (size <= old_size) {
+        latency_path = MEM_LAT_FAST;
+        return ptr;
+    }
+#endif
+
+    void* new_ptr = shared_alloc(size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size);
+        shared_free(ptr);
+    }
+    return new_ptr;
+}
+
+static int check_fail(const char* what, void* where) {
+    fprintf(stderr, "mem_check: %s (%p)\n", what, where);
+    return 1;
+}
+
+int shared_check(void) {
+    if (base == NULL) return 0;
+    SharedHeader* h = header();
+    int errors = 0;
+    size_t free_in_arenas = 0;
+    size_t free_in_bins = 0;
+
+    spin_lock(&h->lock);
+    if (!cover_heap()) {
+        spin_unlock(&h->lock);
+        return check_fail("heap grew beyond this mapping", base + mapped_size);
+    }
+    for (SharedArena* arena = (SharedArena*)at(h->arena_head); arena != NULL;
+         arena = (SharedArena*)at(arena->next)) {
+        char* end = (char*)arena + arena->size;
+        Block* b = (Block*)((char*)arena + SHARED_ARENA_HEADER_SIZE);
+        size_t prev_size = 0;
+        bool prev_free = false;
+        for (;;) {
+            size_t size = block_get_size(b);
+            if (size < block_header_size() || (char*)b + size > end) {
+                errors += check_fail("block size does not fit the arena", b);
+                break;
+            }
+            if (block_get_size_prev(b) != prev_size) errors += check_fail("prev_size_flags does not match previous block", b);
+            bool is_free = !block_get_flag_busy(b);
+            if (is_free && prev_free) errors += check_fail("adjacent free blocks were not coalesced", b);
+            if (is_free) free_in_arenas++;
+            prev_free = is_free;
+            prev_size = size;
+            if (block_get_flag_last(b)) {
+                if ((char*)b + size != end) errors += check_fail("blocks do not tile the arena", b);
+                break;
+            }
+            b = (Block*)((char*)b + size);
+        }
+    }
+
+    for (unsigned bin = 0; bin < SHARED_BINS; bin++) {
+        uint64_t prev = 0;
+        for (uint64_t o = h->bins[bin]; o != 0; o = links((Block*)at(o))->next) {
+            Block* b = (Block*)at(o);
+            if (o >= h->top) {
+                errors += check_fail("bin entry points outside the heap", b);
+                break;
+            }
+            if (block_get_flag_busy(b)) errors += check_fail("bin entry is not a free block", b);
+            if (bin_of(block_get_size(b)) != bin) errors += check_fail("free block is in the wrong bin", b);
+            if (links(b)->prev != prev) errors += check_fail("broken bin back link", b);
+            prev = o;
+            free_in_bins++;
+        }
+    }
+    if (free_in_bins != free_in_arenas) errors += check_fail("free block is missing from the bins", NULL);
+    spin_unlock(&h->lock);
+    return errors;
+}
+
+void shared_stats(MemStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (base == NULL) return;
+    SharedHeader* h = header();
+
+    spin_lock(&h->lock);
+    if (!cover_heap()) {
+        spin_unlock(&h->lock);
+        return;
+    }
+    for (SharedArena* arena = (SharedArena*)at(h->arena_head); arena != NULL;
+         arena = (SharedArena*)at(arena->next)) {
+        stats->arena_count++;
+        stats->mapped_bytes += arena->size;
+    }
+    for (unsigned bin = 0; bin < SHARED_BINS; bin++) {
+        for (uint64_t o = h->bins[bin]; o != 0; o = links((Block*)at(o))->next) {
+            size_t size = block_get_size((Block*)at(o));
+            stats->free_blocks++;
+            stats->free_bytes += size;
+            if (size > stats->largest_free) stats->largest_free = size;
+        }
+    }
+    spin_unlock(&h->lock);
+}
+
+uint64_t shared_offset(void* ptr) {
+    if (base == NULL || ptr == NULL) return 0;
+    return off(ptr);
+}
+
+void* shared_ptr(uint64_t offset) {
+    if (base == NULL) return NULL;
+    return at(offset);
+}
+
+void* shared_root(void) {
+    return base != NULL ? at(header()->root) : NULL;
+}
+
+void shared_set_root(void* ptr) {
+    if (base != NULL) header()->root = off(ptr);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef SHARED_HEAP_H
+#define SHARED_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "allocator.h"
+
+/*
+ * Купа в одному відображенні MAP_SHARED (файл або memfd). Арени
+ * нарізаються з відображення послідовно; список арен, кошики вільних
+ * блоків і корінь користувача зберігаються як зсуви від початку
+ * відображення, тож інший процес (або той самий після перезапуску)
+ * може відобразити файл за будь-якою адресою і продовжити роботу.
+ *
+ * Заголовок містить спінлок, тому купою можуть користуватися кілька
+ * процесів одночасно. Якщо інший процес відкрив файл з більшим розміром,
+ * відображення дорощується на місці в наперед зарезервованих адресах;
+ * менший розмір купу не зменшує. Метадані не захищені від падіння
+ * посеред операції.
+ */
+#define SHARED_MAGIC 0x50414548534d454dull  /* "MEMSHEAP" */
+#define SHARED_VERSION 1
+
+/* Відобразити купу; size 0 - взяти розмір наявного файлу */
+bool shared_open(const char* path, int fd, size_t size, size_t arena_size);
+
+/* Зняти відображення (дані лишаються у файлі) */
+void shared_close(void);
+
+void* shared_alloc(size_t size);
+void shared_free(void* ptr);
+void* shared_realloc(void* ptr, size_t size);
+
+/* Перевірка інваріантів і статистика, як mem_check / mem_stats */
+int shared_check(void);
+void shared_stats(MemStats* stats);
+
+/* Перетворення між вказівником і зсувом у відображенні (0 - NULL) */
+uint64_t shared_offset(void* ptr);
+void* shared_ptr(uint64_t offset);
+
+/* Корінь користувача, що переживає перевідображення */
+void* shared_root(void);
+void shared_set_root(void* ptr);
+
+#endif
\ No newline at end of file
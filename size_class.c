@@ -0,0 +1,34 @@
+#include "size_class.h"
+
+/* Розміри класів: крок 16 до 128, далі чотири класи на степінь двійки */
+#define SIZE_CLASSES(X) \
+    X(32) X(48) X(64) X(80) X(96) X(112) X(128) \
+    X(160) X(192) X(224) X(256) \
+    X(320) X(384) X(448) X(512) \
+    X(640) X(768) X(896) X(1024)
+
+#define SC_SIZE_ENTRY(s) s,
+const size_t size_class_size[SIZE_CLASS_COUNT] = { SIZE_CLASSES(SC_SIZE_ENTRY) };
+
+/* Номер найменшого класу, що вміщує s байтів (константний вираз) */
+#define SC_INDEX(s) \
+    ((s) <= 32  ? 0 : \
+     (s) <= 128 ? ((s) + 15) / 16 - 2 : \
+     (s) <= 256 ? 7 + ((s) - 129) / 32 : \
+     (s) <= 512 ? 11 + ((s) - 257) / 64 : \
+                  15 + ((s) - 513) / 128)
+
+#define SC_G(g) SC_INDEX((g) * SIZE_CLASS_GRANULE)
+#define SC_ROW(g) SC_G(g), SC_G(g + 1), SC_G(g + 2), SC_G(g + 3), \
+                  SC_G(g + 4), SC_G(g + 5), SC_G(g + 6), SC_G(g + 7)
+
+const unsigned char size_class_index[SIZE_CLASS_MAX / SIZE_CLASS_GRANULE + 1] = {
+    SC_ROW(0), SC_ROW(8), SC_ROW(16), SC_ROW(24),
+    SC_ROW(32), SC_ROW(40), SC_ROW(48), SC_ROW(56),
+    SC_G(64)
+};
+
+/* Перевірки узгодженості таблиць під час компіляції */
+#define SC_COUNT_ONE(s) + 1
+typedef char size_class_count_matches[(0 SIZE_CLASSES(SC_COUNT_ONE)) == SIZE_CLASS_COUNT ? 1 : -1];
+typedef char size_class_max_matches[SC_INDEX(SIZE_CLASS_MAX) == SIZE_CLASS_COUNT - 1 ? 1 : -1];
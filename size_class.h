@@ -0,0 +1,27 @@
+#ifndef SIZE_CLASS_H
+#define SIZE_CLASS_H
+
+#include <stddef.h>
+
+/*
+ * Класи розмірів для дрібних блоків (розмір включає заголовок).
+ * До 128 байтів крок 16, далі чотири класи на кожен степінь двійки.
+ * Обидві таблиці будуються препроцесором, тож відображення
+ * розмір -> клас - це одне читання з таблиці.
+ */
+#define SIZE_CLASS_GRANULE 16
+#define SIZE_CLASS_MAX 1024
+#define SIZE_CLASS_COUNT 19
+
+/* Індекс класу для кожної гранули 16 байтів у [0, SIZE_CLASS_MAX] */
+extern const unsigned char size_class_index[SIZE_CLASS_MAX / SIZE_CLASS_GRANULE + 1];
+
+/* Розмір блока кожного класу */
+extern const size_t size_class_size[SIZE_CLASS_COUNT];
+
+/* Клас для розміру блока (block_size <= SIZE_CLASS_MAX) */
+static inline unsigned size_class_of(size_t block_size) {
+    return size_class_index[(block_size + SIZE_CLASS_GRANULE - 1) / SIZE_CLASS_GRANULE];
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+/* Мінімальний спінлок для коротких критичних секцій купи */
+#if defined(_MSC_VER)
+#include <intrin.h>
+typedef volatile long spinlock_t;
+static inline void spin_lock(spinlock_t* l) {
+    while (_InterlockedExchange(l, 1)) {
+        while (*l) _mm_pause();
+    }
+}
+static inline void spin_unlock(spinlock_t* l) {
+    _InterlockedExchange(l, 0);
+}
+#else
+typedef volatile int spinlock_t;
+static inline void spin_lock(spinlock_t* l) {
+    while (__sync_lock_test_and_set(l, 1)) {
+        while (*l) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+    }
+}
+static inline void spin_unlock(spinlock_t* l) {
+    __sync_lock_release(l);
+}
+#endif
+
+#endif
@@ -0,0 +1,458 @@
+#include "tlsf.h"
+#include "block.h"
+#include "spinlock.h"
+#include "hardened.h"
+#include "latency.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if MEM_HARDENED
+#define CANARY_RESERVE MEM_CANARY_SIZE
+#else
+#define CANARY_RESERVE 0
+#endif
+
+#define ALIGN(size) align_up(size, MAX_ALIGN)
+
+#define TLSF_SMALL_BLOCK ((size_t)1 << TLSF_FL_SHIFT)
+/* Пули вирівнюються на 64 КіБ - кратне сторінці на всіх цільових системах */
+#define TLSF_POOL_GRANULE ((size_t)64 * 1024)
+/* Найбільший блок, для якого ще є список */
+#define TLSF_MAX_BLOCK ((size_t)1 << (TLSF_FL_MAX - 1))
+
+typedef struct TlsfPool {
+    size_t size;
+    struct TlsfPool* next;
+} TlsfPool;
+
+/* Зв'язки вільного блока в списку лежать у його payload */
+typedef struct TlsfLinks {
+    Block* next;
+    Block* prev;
+} TlsfLinks;
+
+#define TLSF_POOL_HEADER_SIZE ALIGN(sizeof(TlsfPool))
+
+static uint64_t fl_bitmap = 0;
+static unsigned sl_bitmap[TLSF_FL_COUNT];
+static Block* lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+static TlsfPool* pools = NULL;
+static size_t pool_size = 0;
+static bool fixed_pool = false;
+// Постачальник сторінок, з яким рушій відкрито
+static const PageProvider* pages = &page_mmap;
+static spinlock_t lock;
+
+static unsigned lowest_bit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(v);
+#endif
+}
+
+static unsigned highest_bit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (unsigned)index;
+#else
+    return 63u - (unsigned)__builtin_clzll(v);
+#endif
+}
+
+static TlsfLinks* links(Block* b) {
+    return (TlsfLinks*)block_payload(b);
+}
+
+static Block* next_block(Block* b) {
+    if (block_get_flag_last(b)) return NULL;
+    return (Block*)((char*)b + block_get_size(b));
+}
+
+// Список, у якому лежить вільний блок такого розміру
+static void mapping_insert(size_t size, unsigned* fl, unsigned* sl) {
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (unsigned)(size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT));
+        return;
+    }
+    unsigned f = highest_bit(size);
+    *sl = (unsigned)(size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+    *fl = f - (TLSF_FL_SHIFT - 1);
+}
+
+// Перший список, кожен блок якого гарантовано вміщає size: запит
+// округлюється вгору до межі наступного підсписку
+static bool mapping_search(size_t size, unsigned* fl, unsigned* sl) {
+    if (size >= TLSF_SMALL_BLOCK) {
+        size += ((size_t)1 << (highest_bit(size) - TLSF_SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+    return *fl < TLSF_FL_COUNT;
+}
+
+static void insert_free(Block* b) {
+    unsigned fl, sl;
+    mapping_insert(block_get_size(b), &fl, &sl);
+    TlsfLinks* l = links(b);
+    l->prev = NULL;
+    l->next = lists[fl][sl];
+    if (l->next != NULL) links(l->next)->prev = b;
+    lists[fl][sl] = b;
+    fl_bitmap |= (uint64_t)1 << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+static void remove_free(Block* b) {
+    unsigned fl, sl;
+    mapping_insert(block_get_size(b), &fl, &sl);
+    TlsfLinks* l = links(b);
+    if (l->prev != NULL) {
+        links(l->prev)->next = l->next;
+    } else {
+        lists[fl][sl] = l->next;
+        if (l->next == NULL) {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (sl_bitmap[fl] == 0) fl_bitmap &= ~((uint64_t)1 << fl);
+        }
+    }
+    if (l->next != NULL) links(l->next)->prev = l->prev;
+}
+
+// Голова першого непорожнього придатного списку: дві перевірки бітових карт
+static Block* find_suitable(size_t size) {
+    unsigned fl, sl;
+    if (!mapping_search(size, &fl, &sl)) return NULL;
+
+    unsigned sl_map = sl_bitmap[fl] & (~0u << sl);
+    if (sl_map == 0) {
+        uint64_t fl_map = fl + 1 < 64 ? fl_bitmap & (~(uint64_t)0 << (fl + 1)) : 0;
+        if (fl_map == 0) return NULL;
+        fl = lowest_bit(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+    return lists[fl][lowest_bit(sl_map)];
+}
+
+// Позначити блок вільним, злити з вільними сусідами і покласти у список
+static void release(Block* b) {
+    block_set_flag_busy(b, false);
+
+    Block* next = next_block(b);
+    if (next != NULL && !block_get_flag_busy(next)) {
+        remove_free(next);
+        block_set_flag_last(b, block_get_flag_last(next));
+        block_set_size(b, block_get_size(b) + block_get_size(next));
+    }
+    if (!block_get_flag_first(b)) {
+        Block* prev = block_prev(NULL, b);
+        if (!block_get_flag_busy(prev)) {
+            remove_free(prev);
+            block_set_flag_last(prev, block_get_flag_last(b));
+            block_set_size(prev, block_get_size(prev) + block_get_size(b));
+            b = prev;
+        }
+    }
+    next = next_block(b);
+    if (next != NULL) block_set_size_prev(next, block_get_size(b));
+    insert_free(b);
+}
+
+// Відрізати від зайнятого блока хвіст понад total_size і звільнити його
+static void trim(Block* b, size_t total_size) {
+    size_t size = block_get_size(b);
+    if (size < total_size + block_header_size() * 2) return;
+
+    Block* rest = (Block*)((char*)b + total_size);
+    block_initialize(rest, size - total_size, true, false, block_get_flag_last(b));
+    block_set_size_prev(rest, total_size);
+    Block* after = next_block(rest);
+    if (after != NULL) block_set_size_prev(after, size - total_size);
+
+    block_set_size(b, total_size);
+    block_set_flag_last(b, false);
+    release(rest);
+}
+
+
+// Новий пул з одним вільним блоком на всю довжину; повертає цей блок
+static Block* add_pool(size_t size) {
+    size = align_up(size, TLSF_POOL_GRANULE);
+    LATENCY_SLOW();
+    TlsfPool* pool = (TlsfPool*)page_map(pages, size, 0);
+    if (pool == NULL) return NULL;
+
+    // Фіксований пул торкається одразу, щоб пізніше не було і сторінкових збоїв
+    if (fixed_pool) {
+        for (size_t offset = 0; offset < size; offset += 4096) ((volatile char*)pool)[offset] = 0;
+    }
+
+    pool->size = size;
+    pool->next = pools;
+    pools = pool;
+
+    Block* b = (Block*)((char*)pool + TLSF_POOL_HEADER_SIZE);
+    block_initialize(b, size - TLSF_POOL_HEADER_SIZE, false, true, true);
+    insert_free(b);
+    return b;
+}
+
+bool tlsf_open(size_t size, bool fixed, const PageProvider* provider) {
+    tlsf_close();
+    pages = provider;
+    pool_size = size > 0 ? size : TLSF_DEFAULT_POOL;
+    fixed_pool = fixed;
+    if (add_pool(pool_size) == NULL) {
+        fprintf(stderr, "tlsf: cannot map %lu bytes\n", (unsigned long)pool_size);
+        return false;
+    }
+    return true;
+}
+
+void tlsf_close(void) {
+    while (pools != NULL) {
+        TlsfPool* next = pools->next;
+        page_unmap(pages, pools, pools->size);
+        pools = next;
+    }
+    fl_bitmap = 0;
+    memset(sl_bitmap, 0, sizeof(sl_bitmap));
+    memset(lists, 0, sizeof(lists));
+}
+
+static size_t total_size_of(size_t size) {
+    size_t total_size = ALIGN(size + block_header_size() + CANARY_RESERVE);
+    if (total_size < block_header_size() * 2) total_size = block_header_size() * 2;
+    return total_size;
+}
+
+// Виділення під замком: знайти, вийняти зі списку, відрізати надлишок
+static Block* alloc_locked(size_t total_size) {
+    if (total_size > TLSF_MAX_BLOCK) return NULL;
+    Block* b = find_suitable(total_size);
+    latency_path = MEM_LAT_TREE;
+    if (b == NULL && !fixed_pool) {
+        size_t size = total_size + TLSF_POOL_HEADER_SIZE;
+        b = add_pool(size > pool_size ? size : pool_size);
+        latency_path = MEM_LAT_ARENA;
+    }
+    if (b == NULL) return NULL;
+
+    remove_free(b);
+    block_set_flag_busy(b, true);
+    trim(b, total_size);
+    return b;
+}
+
+void* tlsf_alloc(size_t size) {
+    if (size == 0 || size > SIZE_MAX / 2 || pools == NULL) return NULL;
+
+    spin_lock(&lock);
+    Block* b = alloc_locked(total_size_of(size));
+#if MEM_HARDENED
+    if (b != NULL) hardened_arm(b, size);
+#endif
+    spin_unlock(&lock);
+    return b != NULL ? block_payload(b) : NULL;
+}
+
+void* tlsf_alloc_aligned(size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment <= MAX_ALIGN) return tlsf_alloc(size);
+    if (size == 0 || size > SIZE_MAX / 4 || pools == NULL) return NULL;
+
+    // Голова має вміщати щонайменше мінімальний блок
+    size_t min_gap = block_header_size() * 2;
+    size_t total_size = total_size_of(size);
+
+    spin_lock(&lock);
+    Block* b = alloc_locked(total_size + alignment + min_gap);
+    if (b != NULL && ((uintptr_t)block_payload(b) & (alignment - 1)) != 0) {
+        uintptr_t payload = (uintptr_t)block_payload(b);
+        uintptr_t aligned = (payload + min_gap + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        size_t gap = (size_t)(aligned - payload);
+        size_t size_all = block_get_size(b);
+
+        Block* result = (Block*)((char*)b + gap);
+        block_initialize(result, size_all - gap, true, false, block_get_flag_last(b));
+        block_set_size_prev(result, gap);
+        Block* after = next_block(result);
+        if (after != NULL) block_set_size_prev(after, size_all - gap);
+        block_set_size(b, gap);
+        block_set_flag_last(b, false);
+        release(b);
+        b = result;
+    }
+    if (b != NULL) {
+        trim(b, total_size);
+#if MEM_HARDENED
+        hardened_arm(b, size);
+#endif
+    }
+    spin_unlock(&lock);
+    return b != NULL ? block_payload(b) : NULL;
+}
+
+#if MEM_HARDENED
+static bool owns(void* ptr) {
+    for (TlsfPool* pool = pools; pool != NULL; pool = pool->next) {
+        if ((char*)ptr > (char*)pool && (char*)ptr < (char*)pool + pool->size) return true;
+    }
+    return false;
+}
+#endif
+
+void tlsf_free(void* ptr) {
+    if (ptr == NULL) return;
+
+    Block* b = block_from_payload(ptr);
+#if MEM_HARDENED
+    if (!owns(ptr)) hardened_report("free of pointer not owned by TLSF pools", ptr);
+    hardened_check_busy(b);
+    hardened_poison(b);
+#endif
+
+    spin_lock(&lock);
+    release(b);
+    latency_path = MEM_LAT_TREE;
+    spin_unlock(&lock);
+}
+
+void* tlsf_realloc(void* ptr, size_t size) {
+    if (ptr == NULL) return tlsf_alloc(size);
+    if (size == 0) {
+        tlsf_free(ptr);
+        return NULL;
+    }
+    if (size > SIZE_MAX / 2) return NULL;
+
+    Block* b = block_from_payload(ptr);
+    size_t old_size = block_get_size(b) - block_header_size() - CANARY_RESERVE;
+#if MEM_HARDENED
+    hardened_check_busy(b);
+    old_size = b->requested;
+#endif
+    size_t total_size = total_size_of(size);
+
+    spin_lock(&lock);
+    Block* next = next_block(b);
+    size_t available = block_get_size(b);
+    if (available < total_size && next != NULL && !block_get_flag_busy(next)) {
+        available += block_get_size(next);
+    }
+    if (available >= total_size) {
+        if (block_get_size(b) < total_size) {
+            // Поглинаємо вільного сусіда справа
+            remove_free(next);
+            block_set_flag_last(b, block_get_flag_last(next));
+            block_set_size(b, available);
+            Block* after = next_block(b);
+            if (after != NULL) block_set_size_prev(after, available);
+        }
+        trim(b, total_size);
+#if MEM_HARDENED
+        hardened_arm(b, size);
+#endif
+        spin_unlock(&lock);
+        latency_path = MEM_LAT_FAST;
+        return ptr;
+    }
+    spin_unlock(&lock);
+
+    void* new_ptr = tlsf_alloc(size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+        unsigned char path = latency_path;
+        tlsf_free(ptr);
+        latency_path = path;
+    }
+    return new_ptr;
+}
+
+static int check_fail(const char* what, void* where) {
+    fprintf(stderr, "mem_check: %s (%p)\n", what, where);
+    return 1;
+}
+
+int tlsf_check(void) {
+    int errors = 0;
+    size_t free_in_pools = 0;
+    size_t free_in_lists = 0;
+
+    spin_lock(&lock);
+    for (TlsfPool* pool = pools; pool != NULL; pool = pool->next) {
+        char* end = (char*)pool + pool->size;
+        Block* b = (Block*)((char*)pool + TLSF_POOL_HEADER_SIZE);
+        size_t prev_size = 0;
+        bool prev_free = false;
+        for (;;) {
+            size_t size = block_get_size(b);
+            if (size < block_header_size() || (char*)b + size > end) {
+                errors += check_fail("block size does not fit the pool", b);
+                break;
+            }
+            if (block_get_size_prev(b) != prev_size) errors += check_fail("prev_size_flags does not match previous block", b);
+            bool is_free = !block_get_flag_busy(b);
+            if (is_free && prev_free) errors += check_fail("adjacent free blocks were not coalesced", b);
+            if (is_free) free_in_pools++;
+            prev_free = is_free;
+            prev_size = size;
+            if (block_get_flag_last(b)) {
+                if ((char*)b + size != end) errors += check_fail("blocks do not tile the pool", b);
+                break;
+            }
+            b = (Block*)((char*)b + size);
+        }
+    }
+
+    for (unsigned fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        if (((fl_bitmap >> fl) & 1) != (sl_bitmap[fl] != 0)) errors += check_fail("first-level bitmap is stale", NULL);
+        for (unsigned sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            if (((sl_bitmap[fl] >> sl) & 1) != (lists[fl][sl] != NULL)) {
+                errors += check_fail("second-level bitmap is stale", lists[fl][sl]);
+            }
+            Block* prev = NULL;
+            for (Block* b = lists[fl][sl]; b != NULL; b = links(b)->next) {
+                unsigned bfl, bsl;
+                mapping_insert(block_get_size(b), &bfl, &bsl);
+                if (block_get_flag_busy(b)) errors += check_fail("list entry is not a free block", b);
+                if (bfl != fl || bsl != sl) errors += check_fail("free block is in the wrong list", b);
+                if (links(b)->prev != prev) errors += check_fail("broken list back link", b);
+                prev = b;
+                free_in_lists++;
+            }
+        }
+    }
+    if (free_in_lists != free_in_pools) errors += check_fail("free block is missing from the lists", NULL);
+    spin_unlock(&lock);
+    return errors;
+}
+
+void tlsf_stats(MemStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    spin_lock(&lock);
+    for (TlsfPool* pool = pools; pool != NULL; pool = pool->next) {
+        stats->arena_count++;
+        stats->mapped_bytes += pool->size;
+    }
+    for (unsigned fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        for (unsigned sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            for (Block* b = lists[fl][sl]; b != NULL; b = links(b)->next) {
+                size_t size = block_get_size(b);
+                stats->free_blocks++;
+                stats->free_bytes += size;
+                if (size > stats->largest_free) stats->largest_free = size;
+            }
+        }
+    }
+    spin_unlock(&lock);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "allocator.h"
+#include "page.h"
+
+/*
+ * Рушій Two-Level Segregated Fit: вільні блоки розкладені за списками
+ * (степінь двійки, одна з TLSF_SL_COUNT частин), непорожні списки
+ * позначені у двох рівнях бітових карт. Пошук списку - дві інструкції
+ * пошуку біта, вставка, видалення і злиття з сусідами - сталий час, тож
+ * найгірший випадок виділення і звільнення обмежений без залежності від
+ * кількості блоків.
+ *
+ * Пам'ять береться пулами; у фіксованому режимі єдиний пул відображається
+ * і торкається постранично в tlsf_open, і після цього рушій не звертається
+ * до ОС: вичерпаний пул означає NULL. Інакше для запиту, якому не
+ * знайшлося місця, додається новий пул. Пули повертаються системі лише в
+ * tlsf_close.
+ */
+#define TLSF_SL_LOG2 4
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2)
+/* Блоки, менші за 1 << TLSF_FL_SHIFT, лежать у лінійних списках з кроком MAX_ALIGN */
+#define TLSF_FL_SHIFT (TLSF_SL_LOG2 + 4)
+#define TLSF_FL_MAX 48
+#define TLSF_FL_COUNT (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+/* Розмір пулу за замовчуванням */
+#define TLSF_DEFAULT_POOL (64 * 1024 * 1024)
+
+/* Відобразити перший пул у постачальника pages; fixed - не додавати пулів після старту */
+bool tlsf_open(size_t pool_size, bool fixed, const PageProvider* pages);
+
+/* Повернути системі всі пули */
+void tlsf_close(void);
+
+void* tlsf_alloc(size_t size);
+/* alignment - степінь двійки; голова і хвіст запасу повертаються у вільні */
+void* tlsf_alloc_aligned(size_t alignment, size_t size);
+void tlsf_free(void* ptr);
+/* Зростання на місці поглинає вільного сусіда справа, зменшення віддає хвіст */
+void* tlsf_realloc(void* ptr, size_t size);
+
+/* Перевірка інваріантів і статистика, як mem_check / mem_stats */
+int tlsf_check(void);
+void tlsf_stats(MemStats* stats);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#define atomic_fetch_inc(p) ((unsigned)InterlockedIncrement((volatile LONG*)(p)) - 1)
+#define atomic_cas_ptr(p, o, n) (InterlockedCompareExchangePointer((PVOID volatile*)(p), (n), (o)) == (o))
+#else
+#define TRACE_THREAD_LOCAL __thread
+#define atomic_fetch_inc(p) __sync_fetch_and_add((p), 1)
+#define atomic_cas_ptr(p, o, n) __sync_bool_compare_and_swap((p), (o), (n))
+#endif
+
+typedef struct TraceBuffer {
+    TraceRecord records[TRACE_BUFFER_RECORDS];
+    size_t count;
+    uint16_t thread;
+    struct TraceBuffer* next;
+} TraceBuffer;
+
+volatile bool trace_enabled = false;
+
+static FILE* trace_file = NULL;
+static uint64_t trace_epoch = 0;
+static TraceBuffer* volatile trace_buffers = NULL;
+static volatile unsigned trace_threads = 0;
+static volatile unsigned trace_generation = 0;
+
+static TRACE_THREAD_LOCAL TraceBuffer* local_buffer = NULL;
+static TRACE_THREAD_LOCAL unsigned local_generation = 0;
+
+static uint64_t trace_now(void) {
+#ifdef _WIN32
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Один fwrite на буфер: stdio блокує FILE, тож записи потоків не перемішуються
+static void trace_flush(TraceBuffer* buf) {
+    if (buf->count > 0 && trace_file != NULL) {
+        fwrite(buf->records, sizeof(TraceRecord), buf->count, trace_file);
+    }
+    buf->count = 0;
+}
+
+static TraceBuffer* trace_local(void) {
+    if (local_buffer != NULL && local_generation == trace_generation) return local_buffer;
+
+    TraceBuffer* buf = (TraceBuffer*)malloc(sizeof(TraceBuffer));
+    if (buf == NULL) return NULL;
+    buf->count = 0;
+    buf->thread = (uint16_t)atomic_fetch_inc(&trace_threads);
+
+    // Реєструємо буфер, щоб trace_stop скинув і його
+    TraceBuffer* head;
+    do {
+        head = trace_buffers;
+        buf->next = head;
+    } while (!atomic_cas_ptr(&trace_buffers, head, buf));
+
+    local_buffer = buf;
+    local_generation = trace_generation;
+    return buf;
+}
+
+bool trace_start(const char* path) {
+    if (trace_enabled) trace_stop();
+
+    trace_file = fopen(path, "wb");
+    if (trace_file == NULL) return false;
+
+    TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, (uint16_t)sizeof(TraceRecord)};
+    fwrite(&header, sizeof(header), 1, trace_file);
+
+    trace_epoch = trace_now();
+    trace_threads = 0;
+    trace_generation++;
+    trace_enabled = true;
+    return true;
+}
+
+void trace_stop(void) {
+    if (!trace_enabled) return;
+    trace_enabled = false;
+
+    // Потоки мають бути зупинені або не виділяти пам'ять під час зупинки
+    TraceBuffer* buf = trace_buffers;
+    trace_buffers = NULL;
+    while (buf != NULL) {
+        TraceBuffer* next = buf->next;
+        trace_flush(buf);
+        free(buf);
+        buf = next;
+    }
+    trace_generation++;
+
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+uint64_t trace_clock(void) {
+    return trace_now() - trace_epoch;
+}
+
+void trace_record(uint8_t op, void* ptr, void* old_ptr, size_t size) {
+    trace_record_at(op, ptr, old_ptr, size, trace_clock());
+}
+
+void trace_record_at(uint8_t op, void* ptr, void* old_ptr, size_t size, uint64_t timestamp) {
+    TraceBuffer* buf = trace_local();
+    if (buf == NULL) return;
+
+    TraceRecord* r = &buf->records[buf->count++];
+    r->timestamp_ns = timestamp;
+    r->ptr = (uint64_t)(uintptr_t)ptr;
+    r->old_ptr = (uint64_t)(uintptr_t)old_ptr;
+    r->size = size > UINT32_MAX ? UINT32_MAX : (uint32_t)size;
+    r->thread = buf->thread;
+    r->op = op;
+    r->reserved = 0;
+
+    if (buf->count == TRACE_BUFFER_RECORDS) trace_flush(buf);
+}
@@ -0,0 +1,57 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Запис трас виділень. Кожен потік пише у власний буфер, повний буфер
+ * одним fwrite скидається у файл. Формат файлу: TraceHeader, далі
+ * записи TraceRecord у порядку скидання буферів (не обов'язково за часом).
+ */
+#define TRACE_MAGIC 0x4352544du  /* "MTRC" */
+#define TRACE_VERSION 1
+#define TRACE_BUFFER_RECORDS 4096
+
+enum {
+    TRACE_OP_ALLOC = 1,
+    TRACE_OP_FREE = 2,
+    TRACE_OP_REALLOC = 3
+};
+
+typedef struct TraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+} TraceHeader;
+
+typedef struct TraceRecord {
+    uint64_t timestamp_ns;  /* від початку запису */
+    uint64_t ptr;           /* результат (alloc/realloc) або звільнений вказівник */
+    uint64_t old_ptr;       /* для realloc - вихідний вказівник */
+    uint32_t size;          /* запитаний розмір */
+    uint16_t thread;        /* порядковий номер потоку */
+    uint8_t op;
+    uint8_t reserved;
+} TraceRecord;
+
+/* Прапорець для швидкої перевірки у гарячому шляху */
+extern volatile bool trace_enabled;
+
+/* Почати запис у файл; false, якщо файл не відкрився */
+bool trace_start(const char* path);
+
+/* Скинути буфери всіх потоків і закрити файл */
+void trace_stop(void);
+
+/* Додати запис до буфера поточного потоку */
+void trace_record(uint8_t op, void* ptr, void* old_ptr, size_t size);
+
+/* Те саме з моментом, взятим trace_clock до операції: realloc звільняє
+ * старий блок всередині, і його адресу може виділити інший потік раніше,
+ * ніж запис був би зроблено після операції */
+uint64_t trace_clock(void);
+void trace_record_at(uint8_t op, void* ptr, void* old_ptr, size_t size, uint64_t timestamp);
+
+#endif
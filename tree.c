@@ -1,9 +1,16 @@
 #include "tree.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 static int max2(int a, int b) { return a > b ? a : b; }
 
+/* Порядок вузлів: за ключем, а однакові ключі - за адресою даних */
+static int node_less(size_t key, void* data, struct Node* node) {
+    if (key != node->key) return key < node->key;
+    return (uintptr_t)data < (uintptr_t)node->data;
+}
+
 struct Node* node_new(size_t key, void* data) {
     struct Node* n = (struct Node*)malloc(sizeof(struct Node));
     if (!n) return NULL;
@@ -64,7 +71,7 @@ struct Node* node_balance(struct Node* node) {
 
 struct Node* node_insert(struct Node* root, size_t key, void* data) {
     if (!root) return node_new(key, data);
-    if (key < root->key)
+    if (node_less(key, data, root))
         root->left = node_insert(root->left, key, data);
     else
         root->right = node_insert(root->right, key, data);
@@ -100,6 +107,55 @@ struct Node* node_remove(struct Node* root, size_t key) {
     return node_balance(root);
 }
 
+struct Node* node_remove_exact(struct Node* root, size_t key, void* data) {
+    if (!root) return NULL;
+    if (key == root->key && data == root->data) {
+        struct Node* l = root->left;
+        struct Node* r = root->right;
+        free(root);
+        if (!r) return l;
+        struct Node* min = node_find_min(r);
+        min->right = node_remove_min(r);
+        min->left = l;
+        return node_balance(min);
+    }
+    if (node_less(key, data, root))
+        root->left = node_remove_exact(root->left, key, data);
+    else
+        root->right = node_remove_exact(root->right, key, data);
+    return node_balance(root);
+}
+
+void node_destroy(struct Node* node) {
+    if (!node) return;
+    node_destroy(node->left);
+    node_destroy(node->right);
+    free(node);
+}
+
+void node_foreach(struct Node* node, void (*fn)(struct Node*, void*), void* ctx) {
+    if (!node) return;
+    node_foreach(node->left, fn, ctx);
+    fn(node, ctx);
+    node_foreach(node->right, fn, ctx);
+}
+
+static int check_range(struct Node* node, struct Node* lo, struct Node* hi) {
+    if (!node) return 0;
+    int errors = 0;
+    if ((lo && !node_less(lo->key, lo->data, node)) || (hi && !node_less(node->key, node->data, hi))) errors++;
+    int hl = node_height(node->left);
+    int hr = node_height(node->right);
+    if (node->height != max2(hl, hr) + 1 || hl - hr > 1 || hr - hl > 1) errors++;
+    errors += check_range(node->left, lo, node);
+    errors += check_range(node->right, node, hi);
+    return errors;
+}
+
+int node_check(struct Node* node) {
+    return check_range(node, NULL, NULL);
+}
+
 void node_show(struct Node* node) {
     if (!node) {
         printf("  (empty tree)\n");
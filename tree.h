@@ -28,7 +28,7 @@ struct Node* node_rotate_left(struct Node* q);
 /* Балансування вузла */
 struct Node* node_balance(struct Node* node);
 
-/* Вставка ключа з даними */
+/* Вставка ключа з даними; вузли впорядковані за парою (ключ, адреса даних) */
 struct Node* node_insert(struct Node* root, size_t key, void* data);
 
 /* Пошук найменшого ключа */
@@ -40,6 +40,18 @@ struct Node* node_remove_min(struct Node* root);
 /* Видалення ключа */
 struct Node* node_remove(struct Node* root, size_t key);
 
+/* Видалення саме того вузла, що має заданий ключ і дані, за O(log n) */
+struct Node* node_remove_exact(struct Node* root, size_t key, void* data);
+
+/* Звільнення всіх вузлів дерева */
+void node_destroy(struct Node* node);
+
+/* Обхід вузлів у порядку зростання ключа */
+void node_foreach(struct Node* node, void (*fn)(struct Node*, void*), void* ctx);
+
+/* Перевірка впорядкованості та висот AVL; повертає кількість порушень */
+int node_check(struct Node* node);
+
 /* Діагностика дерева */
 void node_show(struct Node* node);
 